@@ -2,21 +2,20 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aInstance; // per-instance transform, applied after the model matrix
 
 out vec3 Diffuse;
 out vec3 Specular;
 out vec2 TexCoords;
 
+// Members are ordered to pack into std140 without padding between the vec3s and floats
 struct PointLight {
     vec3 position;
-
-    // attenuation factors
-    float constant;
-    float linear;
-    float quadratic;
-
+    float constant; // attenuation factors
     vec3 ambient;
+    float linear;
     vec3 diffuse;
+    float quadratic;
     vec3 specular;
 };
 
@@ -29,16 +28,37 @@ struct DirLight {
 };
 
 #define MAX_POINT_LIGHTS 4
-uniform int nr_point_lights;
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
 
-uniform DirLight dirLight;
+// Shared by every object shader, binding must match LIGHTING_UBO_BINDING
+layout (std140, binding = 0) uniform LightingBlock {
+    DirLight dirLight;
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    int nr_point_lights;
+};
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 uniform mat3 normalMatrix;
 
+// Dequantization of packed positions, identity for float vertices
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform bool octNormals; // normals are octahedral encoded in aNormal.xy
+
+uniform bool instanced; // aInstance is only sourced from a buffer when drawing instances
+
+vec3 DecodeNormal(vec3 normal)
+{
+    if (!octNormals) return normal;
+
+    vec3 n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
 uniform highp float shininess; // shininess must remain outside of material for phong and gouraud to be interchangeable
 
 // ======== FUNCTION DECLARATIONS ========
@@ -49,11 +69,21 @@ mat3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 // ======== MAIN ========
 void main() 
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    vec3 localPos = positionOffset + aPos * positionScale;
+    vec3 localNormal = DecodeNormal(aNormal);
+
+    mat4 instance = instanced ? aInstance : mat4(1.0);
+    mat4 world = instance * model;
+
+    // Instances only rotate, translate and scale uniformly, so their rotation is applied in view space
+    mat3 viewRotation = mat3(view);
+    mat3 instanceRotation = viewRotation * mat3(instance) * transpose(viewRotation);
+
+    gl_Position = projection * view * world * vec4(localPos, 1.0);
     TexCoords = aTexCoords;
 
-    vec3 Normal = normalize(normalMatrix * aNormal); // normal in view space (normal matrix is the inverse transpose of the view*model matrix)
-    vec3 Position = vec3(view * model * vec4(aPos, 1.0)); // position in view space
+    vec3 Normal = normalize(instanceRotation * normalMatrix * localNormal); // normal in view space (normal matrix is the inverse transpose of the view*model matrix)
+    vec3 Position = vec3(view * world * vec4(localPos, 1.0)); // position in view space
     vec3 ViewDir = normalize(-Position);
 
     // directional light
@@ -5,16 +5,14 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
 
+// Members are ordered to pack into std140 without padding between the vec3s and floats
 struct PointLight {
     vec3 position;
-
-    // attenuation factors
-    float constant;
-    float linear;
-    float quadratic;
-
+    float constant; // attenuation factors
     vec3 ambient;
+    float linear;
     vec3 diffuse;
+    float quadratic;
     vec3 specular;
 };
 
@@ -27,10 +25,13 @@ struct DirLight {
 };
 
 #define MAX_POINT_LIGHTS 4
-uniform int nr_point_lights;
-uniform PointLight pointLights[MAX_POINT_LIGHTS];
 
-uniform DirLight dirLight;
+// Shared by every object shader, binding must match LIGHTING_UBO_BINDING
+layout (std140, binding = 0) uniform LightingBlock {
+    DirLight dirLight;
+    PointLight pointLights[MAX_POINT_LIGHTS];
+    int nr_point_lights;
+};
 
 struct Material {
     sampler2D texture_diffuse[8];
@@ -2,6 +2,7 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aInstance; // per-instance transform, applied after the model matrix
 
 out vec3 FragPos;
 out vec3 Normal;
@@ -12,11 +13,39 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform mat3 normalMatrix;
 
+// Dequantization of packed positions, identity for float vertices
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform bool octNormals; // normals are octahedral encoded in aNormal.xy
+
+uniform bool instanced; // aInstance is only sourced from a buffer when drawing instances
+
+vec3 DecodeNormal(vec3 normal)
+{
+    if (!octNormals) return normal;
+
+    vec3 n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
 
 void main() 
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    Normal = normalize(normalMatrix * aNormal);
-    FragPos = vec3(view * model * vec4(aPos, 1.0));
+    vec3 localPos = positionOffset + aPos * positionScale;
+    vec3 localNormal = DecodeNormal(aNormal);
+
+    mat4 instance = instanced ? aInstance : mat4(1.0);
+    mat4 world = instance * model;
+
+    // Instances only rotate, translate and scale uniformly, so their rotation is applied in view space
+    mat3 viewRotation = mat3(view);
+    mat3 instanceRotation = viewRotation * mat3(instance) * transpose(viewRotation);
+
+    gl_Position = projection * view * world * vec4(localPos, 1.0);
+    Normal = normalize(instanceRotation * normalMatrix * localNormal);
+    FragPos = vec3(view * world * vec4(localPos, 1.0));
     TexCoords = aTexCoords;
 }
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <future>
+#include <memory>
 #include "camera.hpp"
 #include "rendering/model.hpp"
+#include "rendering/passTimers.hpp"
 #include "utils/constants.hpp"
+#include "utils/options.hpp"
 
 class Window;
 
@@ -14,8 +19,12 @@ private:
     int modelSelect = 7; ///< Select default model as Space Shuttle.
     int shaderSelect = 0; ///< Select default shader as Phong.
 
+    ModelSettings modelSettings; ///< Select model settings, initially given on the command line.
+
     int selectedModel; ///< Selected model index.
     int selectedShader; ///< Selected shader index.
+    bool shaderCompiling = false; ///< Whether the selected shader is still being built, the previous one is drawn meanwhile.
+    ModelSettings selectedModelSettings; ///< Settings of the current model.
 
     bool relativeMouseMode = false; ///< Flag to indicate if the mouse is in relative mode.
     bool isUiCollapsed = false; ///< Flag to track if UI is collapsed.
@@ -23,11 +32,56 @@ private:
 
     RotationMode modelRotationMode = RotationMode::NATURAL_ROTATION; ///< Model rotation mode (natural or input-based).
 
+    std::future<std::unique_ptr<Model>> modelLoad; ///< Background job loading the next model from disk.
+    std::unique_ptr<Model> pendingModel; ///< Loaded model whose GPU upload is in progress.
+    int loadingModel = -1; ///< Index of the model being loaded, -1 when idle.
+    ModelSettings loadingModelSettings; ///< Settings of the model being loaded.
+
+    double memoryBeforeLoad = 0.0; ///< Process memory usage in MB before the last model load.
+    double memoryAfterLoad = 0.0; ///< Process memory usage in MB once the last model replaced the previous one.
+    std::atomic<float> loadProgress = 0.0f; ///< Progress of the model being loaded, between 0 and 1.
+    RenderQueueStats renderQueueStats; ///< State changes of the last frame drawn through the render queue.
+    GpuPassTimes gpuPassTimes; ///< GPU time of each render pass, read back once available.
+
+    int instanceCount = 1; ///< Number of copies of the model drawn in a grid.
+
+    RayHit lastPick; ///< Last point picked on the model with [Ctrl + Click].
+    glm::vec3 measurePoints[2]; ///< Points measured with [Shift + Click], in model space.
+    int measurePointCount = 0; ///< Number of measured points, the third click starts a new measure.
+
+    /**
+     * @brief Starts loading the selected model on a worker thread.
+     */
+    void startModelLoad();
+
+    /**
+     * @brief Casts a ray from the camera through the cursor and picks the model triangle under it.
+     * 
+     * @param window The window the cursor is in.
+     * @param camera The camera the scene is seen from.
+     * @param model The model to pick.
+     * @param x Cursor position from the left of the window, in pixels.
+     * @param y Cursor position from the top of the window, in pixels.
+     * @return The closest hit, if any.
+     */
+    RayHit pickModel(Window& window, const Camera& camera, const Model& model, int x, int y) const;
+
 public:
     /**
      * @brief Constructs a UIHandler with default selections.
+     * 
+     * @param options The command line options providing the initial selections.
      */
-    UIHandler() : selectedModel(modelSelect), selectedShader(shaderSelect) {};
+    UIHandler(const Options& options = Options()) 
+        : modelSettings(options.modelSettings), selectedModel(modelSelect), selectedShader(shaderSelect), 
+          selectedModelSettings(modelSettings) {};
+
+    /**
+     * @brief Waits for a model load still running in the background.
+     * 
+     * Only a backstop, cancelModelLoad() must run first when the load may hold GPU resources.
+     */
+    ~UIHandler();
 
     /**
      * @brief Handles input events like keyboard and mouse input for camera and model controls.
@@ -41,10 +95,35 @@ public:
     /**
      * @brief Changes the current model based on user selection.
      * 
+     * The model is also reloaded when different model settings are selected.
+     * 
+     * The new model is loaded on a worker thread while the current one keeps rendering. Once
+     * loaded, its GPU upload is spread across frames and the models are swapped when it completes.
+     * Must be called once per frame from the GL thread.
+     * 
      * @param model A unique pointer to the model to be changed.
      * @param camera The camera object to update based on the new model.
+     * @return True if the model was swapped during this call.
+     */
+    bool changeModel(std::unique_ptr<Model>& model, Camera& camera);
+
+    /**
+     * @brief Abandons the model switch in progress, if any.
+     * 
+     * Waits for the background load, then frees the loaded model and whatever part of it was
+     * already uploaded. Must be called from the GL thread while the context still exists.
      */
-    void changeModel(std::unique_ptr<Model>& model, Camera& camera);
+    void cancelModelLoad();
+
+    /**
+     * @brief Lays the selected number of model instances out in a grid.
+     * 
+     * The instance transforms are only rebuilt when the count changed or a new model was swapped in.
+     * Must be called from the GL thread.
+     * 
+     * @param model The model to instance.
+     */
+    void changeInstances(Model& model);
 
     /**
      * @brief Changes the shader based on the user's selection.
@@ -54,11 +133,26 @@ public:
     int changeShader();
 
     /**
-     * @brief Loads a new model based on the selected model index.
+     * @brief Gets the path of a selectable model file.
+     * 
+     * @param index The model select index.
+     * @return The full path to the model file.
+     */
+    static std::string getModelPath(int index);
+
+    /**
+     * @brief Checks whether a model is being loaded in the background.
+     * 
+     * @return True while a model load or upload is in progress.
+     */
+    bool isLoadingModel() const { return loadingModel != -1; }
+
+    /**
+     * @brief Gets the progress of the model being loaded.
      * 
-     * @return A unique pointer to the newly loaded model.
+     * @return The load progress, between 0 and 1.
      */
-    std::unique_ptr<Model> loadNewModel();
+    float getLoadProgress() const { return loadProgress.load(); }
 
     /**
      * @brief Sets the model select index.
@@ -67,6 +161,77 @@ public:
      */
     void setModelSelect(int newModelSelect) { modelSelect = newModelSelect; }
 
+    /**
+     * @brief Sets the import profile select index.
+     * 
+     * @param newImportProfileSelect The new import profile select index.
+     */
+    void setImportProfileSelect(int newImportProfileSelect) { modelSettings.importProfile = static_cast<ImportProfile>(newImportProfileSelect); }
+
+    /**
+     * @brief Sets the lean residency mode used for the next model loads.
+     * 
+     * @param newLeanResidency True to free CPU copies of model geometry once uploaded.
+     */
+    void setLeanResidency(bool newLeanResidency) { modelSettings.leanResidency = newLeanResidency; }
+
+    /**
+     * @brief Sets whether the next model loads run the mesh optimizer.
+     * 
+     * @param newMeshOptimization True to reorder triangles and vertices for the GPU caches.
+     */
+    void setMeshOptimization(bool newMeshOptimization) { modelSettings.meshOptimization = newMeshOptimization; }
+
+    /**
+     * @brief Sets whether the next model loads use the packed vertex layout.
+     * 
+     * @param newPackedVertices True to upload 16 byte quantized vertices instead of 32 byte floats.
+     */
+    void setPackedVertices(bool newPackedVertices) { modelSettings.packedVertices = newPackedVertices; }
+
+    /**
+     * @brief Sets whether the next model loads split meshes to fit 16-bit indices.
+     * 
+     * @param newSplitIndexBuffers True to split meshes slightly over the 16-bit vertex limit.
+     */
+    void setSplitIndexBuffers(bool newSplitIndexBuffers) { modelSettings.splitIndexBuffers = newSplitIndexBuffers; }
+
+    /**
+     * @brief Sets whether the next model loads generate levels of detail.
+     * 
+     * @param newGenerateLods True to build simplified levels of detail.
+     */
+    void setGenerateLods(bool newGenerateLods) { modelSettings.generateLods = newGenerateLods; }
+
+    /**
+     * @brief Records the memory usage around a model load done outside of the handler.
+     * 
+     * @param before Memory usage in MB before the load.
+     * @param after Memory usage in MB after the load.
+     */
+    void setLoadMemoryUsage(double before, double after) { memoryBeforeLoad = before; memoryAfterLoad = after; }
+
+    /**
+     * @brief Sets the number of model instances to draw.
+     * 
+     * @param newInstanceCount The instance count, 1 draws the model once without instancing.
+     */
+    void setInstanceCount(int newInstanceCount) { instanceCount = newInstanceCount; }
+
+    /**
+     * @brief Records the state changes of the last frame drawn through the render queue.
+     * 
+     * @param stats The stats of the executed queue.
+     */
+    void setRenderQueueStats(const RenderQueueStats& stats) { renderQueueStats = stats; }
+
+    /**
+     * @brief Records the GPU time of each render pass read back by the pass timers.
+     * 
+     * @param times The latest pass times.
+     */
+    void setGpuPassTimes(const GpuPassTimes& times) { gpuPassTimes = times; }
+
     /**
      * @brief Sets the shader select index.
      * 
@@ -74,6 +239,13 @@ public:
      */
     void setShaderSelect(int newShaderSelect) { shaderSelect = newShaderSelect; }
 
+    /**
+     * @brief Records whether the selected shader is still being built.
+     * 
+     * @param compiling True while the previous shader is drawn in its place.
+     */
+    void setShaderCompiling(bool compiling) { shaderCompiling = compiling; }
+
     /**
      * @brief Sets the flag to show or hide the grid.
      * 
@@ -95,6 +267,83 @@ public:
      */
     int getModelSelect() const { return modelSelect; }
 
+    /**
+     * @brief Gets the selected import profile index.
+     * 
+     * @return The current selected import profile index.
+     */
+    int getImportProfileSelect() const { return (int) modelSettings.importProfile; }
+
+    /**
+     * @brief Gets the lean residency mode used for the next model loads.
+     * 
+     * @return True if CPU copies of model geometry are freed once uploaded.
+     */
+    bool getLeanResidency() const { return modelSettings.leanResidency; }
+
+    /**
+     * @brief Gets whether the next model loads run the mesh optimizer.
+     * 
+     * @return True if triangles and vertices are reordered for the GPU caches.
+     */
+    bool getMeshOptimization() const { return modelSettings.meshOptimization; }
+
+    /**
+     * @brief Gets whether the next model loads use the packed vertex layout.
+     * 
+     * @return True if vertices are uploaded as 16 byte quantized vertices.
+     */
+    bool getPackedVertices() const { return modelSettings.packedVertices; }
+
+    /**
+     * @brief Gets whether the next model loads split meshes to fit 16-bit indices.
+     * 
+     * @return True if meshes slightly over the 16-bit vertex limit are split.
+     */
+    bool getSplitIndexBuffers() const { return modelSettings.splitIndexBuffers; }
+
+    /**
+     * @brief Gets whether the next model loads generate levels of detail.
+     * 
+     * @return True if simplified levels of detail are built.
+     */
+    bool getGenerateLods() const { return modelSettings.generateLods; }
+
+    /**
+     * @brief Gets the memory usage before the last model load.
+     * 
+     * @return The memory usage in MB.
+     */
+    double getMemoryBeforeLoad() const { return memoryBeforeLoad; }
+
+    /**
+     * @brief Gets the memory usage after the last model load.
+     * 
+     * @return The memory usage in MB.
+     */
+    double getMemoryAfterLoad() const { return memoryAfterLoad; }
+
+    /**
+     * @brief Gets the number of model instances to draw.
+     * 
+     * @return The instance count.
+     */
+    int getInstanceCount() const { return instanceCount; }
+
+    /**
+     * @brief Gets the state changes of the last frame drawn through the render queue.
+     * 
+     * @return The render queue stats.
+     */
+    const RenderQueueStats& getRenderQueueStats() const { return renderQueueStats; }
+
+    /**
+     * @brief Gets the GPU time of each render pass.
+     * 
+     * @return The latest pass times.
+     */
+    const GpuPassTimes& getGpuPassTimes() const { return gpuPassTimes; }
+
     /**
      * @brief Gets the selected shader index.
      * 
@@ -102,6 +351,13 @@ public:
      */
     int getShaderSelect() const { return shaderSelect; }
 
+    /**
+     * @brief Gets whether the selected shader is still being built.
+     * 
+     * @return True while the previous shader is drawn in its place.
+     */
+    bool isShaderCompiling() const { return shaderCompiling; }
+
     /**
      * @brief Gets the flag indicating whether to show the grid.
      * 
@@ -115,4 +371,25 @@ public:
      * @return The current rotation mode for the model.
      */
     RotationMode getModelRotationMode() const { return modelRotationMode; }
+
+    /**
+     * @brief Gets the last point picked on the model.
+     * 
+     * @return The last pick, without hit if the ray missed or nothing was picked yet.
+     */
+    const RayHit& getLastPick() const { return lastPick; }
+
+    /**
+     * @brief Gets the number of points of the current measure.
+     * 
+     * @return 0, 1 or 2 points.
+     */
+    int getMeasurePointCount() const { return measurePointCount; }
+
+    /**
+     * @brief Gets the distance between the two measured points.
+     * 
+     * @return The distance in model units, 0 until both points are picked.
+     */
+    float getMeasuredDistance() const { return measurePointCount == 2 ? glm::length(measurePoints[1] - measurePoints[0]) : 0.0f; }
 };
@@ -196,6 +196,21 @@ public:
      */
     void calculateYawPitchFromVector(const glm::vec3& direction);
 
+    /** 
+     * @brief Turns the camera towards a point without moving it.
+     * 
+     * @param point The point to look at, in world space.
+     */
+    void focusOn(const glm::vec3& point);
+
+    /** 
+     * @brief Moves the camera along a circle around the vertical axis through a point, looking at it.
+     * 
+     * @param center The point to orbit, in world space.
+     * @param angle The angle to move by, in degrees.
+     */
+    void orbit(const glm::vec3& center, float angle);
+
     /** 
      * @brief Resets the camera to its default configuration.
      */
@@ -2,7 +2,7 @@
 
 #include <glm/glm.hpp>
 
-#include "shader/shaderProgram.hpp"
+#include "lighting/lightingBlock.hpp"
 #include "utils/constants.hpp"
 
 
@@ -132,13 +132,13 @@ public:
     void setDirection(float azimuth, float elevation);
 
     /**
-     * @brief Configures shader uniforms with this light's properties
+     * @brief Gets this light's entry of the lighting uniform block
      * 
-     * Sets directional light uniforms including direction, ambient, diffuse, and specular
-     * components based on the light's color and intensity values. Uses constants from
-     * constants.hpp (DEFAULT_LIGHT_AMBIENT, DEFAULT_LIGHT_DIFFUSE, DEFAULT_LIGHT_SPECULAR).
+     * Computes the ambient, diffuse, and specular components from the light's color and
+     * intensity values. Uses constants from constants.hpp (DEFAULT_LIGHT_AMBIENT,
+     * DEFAULT_LIGHT_DIFFUSE, DEFAULT_LIGHT_SPECULAR).
      * 
-     * @param shaderProgram Reference to the shader program to configure
+     * @return The directional light as laid out in the uniform block
      */
-    void setUniformsForShaderProgram(ShaderProgram& shaderProgram);
+    DirLightBlock getBlockData() const;
 };
\ No newline at end of file
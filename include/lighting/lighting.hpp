@@ -6,6 +6,7 @@
 #include "rendering/model.hpp"
 #include "lighting/pointLight.hpp"
 #include "lighting/lightCaster.hpp"
+#include "lighting/lightingBlock.hpp"
 #include "shader/shaderProgram.hpp"
 
 /**
@@ -17,6 +18,9 @@
  * properties, and configure shaders with the appropriate lighting uniforms.
  * The system also handles transforming light positions to view space and drawing
  * visual representations of point lights.
+ * 
+ * The lights reach the object shaders through one uniform buffer bound at
+ * LIGHTING_UBO_BINDING, so switching shaders costs nothing for lighting state.
  */
 class Lighting {
 private:
@@ -27,6 +31,9 @@ private:
     Camera* camera;                   ///< Pointer to the camera (needed for light placement in view frustum)
     Model* model;                     ///< Pointer to the model (needed for light placement relative to model)
     bool showPointLights = true;      ///< Whether to render the visual representation of point lights
+    GlBuffer uniformBuffer;           ///< Buffer backing the LightingBlock of the object shaders, created on first update
+    LightingBlock uploadedBlock = {}; ///< Contents of the uniform buffer, compared against to skip redundant uploads
+    size_t uniformUploads = 0;        ///< Number of times the uniform buffer was written
 
 public:
     /**
@@ -49,6 +56,12 @@ public:
      */
     int getNPointLights() const { return pointLights.size(); }
 
+    /**
+     * @brief Gets how many times the lighting uniform buffer was written
+     * @return Number of uploads since the buffer was created
+     */
+    size_t getUniformUploads() const { return uniformUploads; }
+
     /**
      * @brief Gets a pointer to the directional light
      * @return Pointer to the LightCaster object
@@ -122,13 +135,18 @@ public:
     void drawPointLights(ShaderProgram& pointLightShader);
 
     /**
-     * @brief Configures shader uniforms for all lights in the scene
+     * @brief Brings the lighting uniform buffer up to date
      * 
-     * Sets uniforms for the directional light and all point lights, including
-     * transforming point light positions to view space. Also sets the number
-     * of active point lights.
-     * 
-     * @param lightingShader Shader program to configure with lighting uniforms
+     * Gathers the directional light and all point lights, with point light positions
+     * transformed to view space by the current view matrix, and uploads them with a
+     * single glBufferSubData only if they differ from what the buffer already holds.
+     * Lights are edited through their own setters, so comparing the gathered block is
+     * what tracks their changes.
+     */
+    void updateUniformBuffer();
+
+    /**
+     * @brief Releases the uniform buffer and the point lights, must be called while the GL context exists
      */
-    void setUniformsForShaderProgram(ShaderProgram& lightingShader);
+    void cleanup();
 };
\ No newline at end of file
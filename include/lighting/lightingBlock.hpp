@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+#include "utils/constants.hpp"
+
+/**
+ * @struct PointLightBlock
+ * @brief A point light as laid out in the std140 LightingBlock of the object shaders
+ */
+struct PointLightBlock {
+    glm::vec3 position;     ///< Position in view space
+    float constant;         ///< Constant attenuation factor
+    glm::vec3 ambient;      ///< Ambient colour
+    float linear;           ///< Linear attenuation factor
+    glm::vec3 diffuse;      ///< Diffuse colour
+    float quadratic;        ///< Quadratic attenuation factor
+    glm::vec3 specular;     ///< Specular colour
+    float padding;          ///< Rounds the struct up to a multiple of 16 bytes
+};
+
+/**
+ * @struct DirLightBlock
+ * @brief A directional light as laid out in the std140 LightingBlock of the object shaders
+ */
+struct DirLightBlock {
+    glm::vec3 direction;    ///< Direction the light travels
+    float padding0;
+    glm::vec3 ambient;      ///< Ambient colour
+    float padding1;
+    glm::vec3 diffuse;      ///< Diffuse colour
+    float padding2;
+    glm::vec3 specular;     ///< Specular colour
+    float padding3;
+};
+
+/**
+ * @struct LightingBlock
+ * @brief CPU copy of the LightingBlock uniform block shared by the object shaders
+ *
+ * Every member is written explicitly, padding included, so two blocks can be compared bytewise.
+ */
+struct LightingBlock {
+    DirLightBlock dirLight;                             ///< The directional light
+    PointLightBlock pointLights[MAX_POINT_LIGHTS];      ///< The point lights, unused entries are zeroed
+    GLint nrPointLights;                                ///< Number of point lights in use
+    GLint padding[3];
+};
+
+static_assert(sizeof(PointLightBlock) == 64, "PointLightBlock must match the std140 PointLight struct");
+static_assert(sizeof(DirLightBlock) == 64, "DirLightBlock must match the std140 DirLight struct");
+static_assert(offsetof(LightingBlock, pointLights) == 64, "LightingBlock must match the std140 block layout");
+static_assert(offsetof(LightingBlock, nrPointLights) == 64 + 64 * MAX_POINT_LIGHTS, "LightingBlock must match the std140 block layout");
@@ -4,7 +4,8 @@
 #include <string>
 
 #include "object.hpp"
-#include "shader/shaderProgram.hpp"
+#include "lighting/lightingBlock.hpp"
+#include "rendering/gpuResource.hpp"
 
 /**
  * @class PointLight
@@ -13,11 +14,13 @@
  * The PointLight class simulates a light that radiates in all directions from a point
  * in 3D space. It inherits from Object to have position and transformation capabilities.
  * The light includes a visible mesh representation (cube) and realistic attenuation
- * using constant, linear, and quadratic factors.
+ * using constant, linear, and quadratic factors. The light owns the cube's GL objects,
+ * so it can be moved but not copied.
  */
 class PointLight : public Object {
 private:
-    GLuint VAO, VBO, EBO;             ///< OpenGL buffer objects for the light's visual representation
+    GlVertexArray VAO;                ///< Vertex array of the light's visual representation
+    GlBuffer VBO, EBO;                ///< Vertex and index buffers of the light's visual representation
     int nIndices;                     ///< Number of indices in the mesh's element buffer
     glm::vec3 colour;                 ///< Light color (RGB)
     float intensity;                  ///< Light brightness multiplier
@@ -81,13 +84,13 @@ public:
     void draw();
 
     /**
-     * @brief Configures shader uniforms with this light's properties
+     * @brief Gets this light's entry of the lighting uniform block
      * 
-     * Sets point light uniforms including position, color components, and attenuation
+     * Includes the position transformed to view space, color components, and attenuation
      * factors. Uses constants from constants.hpp for default multipliers.
      * 
-     * @param shaderProgram Reference to the shader program to configure
-     * @param i String index for the light in a lights array (e.g., "0" for first light)
+     * @param view The view matrix the object shaders light in
+     * @return The point light as laid out in the uniform block
      */
-    void setUniformsForShaderProgram(ShaderProgram& shaderProgram, const std::string& i);
+    PointLightBlock getBlockData(const glm::mat4& view) const;
 };
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "rendering/mesh.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @struct RayHit
+ * @brief Closest intersection of a ray with a model
+ */
+struct RayHit {
+    bool hit = false;                       ///< Whether the ray hit any triangle
+    float distance = 0.0f;                  ///< Distance from the ray origin to the hit, in ray direction units
+    glm::vec3 position = glm::vec3(0.0f);   ///< Position of the hit, in world space
+    glm::vec3 localPosition = glm::vec3(0.0f); ///< Position of the hit, in model space
+    uint32_t meshIndex = 0;                 ///< Index of the mesh that was hit
+    uint32_t triangleIndex = 0;             ///< Index of the triangle within its mesh's full resolution indices
+    uint32_t instanceIndex = 0;             ///< Index of the model instance that was hit, 0 if not instanced
+};
+
+/**
+ * @class Bvh
+ * @brief Bounding volume hierarchy over the triangles of a model, for CPU ray casts
+ *
+ * Built top-down with a binned surface area heuristic. Nodes are stored in one array, 32 bytes
+ * each so two share a cache line, and the children of a node are always adjacent so only the
+ * first one is referenced. Leaves reference a run of triangles copied in hierarchy order with
+ * their edges precomputed, so a traversal never touches the mesh data.
+ */
+class Bvh {
+private:
+    /**
+     * @struct Node
+     * @brief A node of the hierarchy, the padding lanes of the bounds hold the links
+     */
+    struct Node {
+        glm::vec3 minBounds;    ///< Minimum corner of the node's box
+        uint32_t leftFirst;     ///< First child for inner nodes, first triangle for leaves
+        glm::vec3 maxBounds;    ///< Maximum corner of the node's box
+        uint32_t count;         ///< Number of triangles of a leaf, 0 for inner nodes
+    };
+    static_assert(sizeof(Node) == 32, "Bvh nodes must stay 32 bytes");
+
+    /**
+     * @struct Triangle
+     * @brief A triangle ready for the Möller-Trumbore test
+     */
+    struct Triangle {
+        glm::vec3 v0;           ///< First corner
+        glm::vec3 edge1;        ///< Second corner minus the first
+        glm::vec3 edge2;        ///< Third corner minus the first
+        uint32_t meshIndex;     ///< Mesh the triangle belongs to
+        uint32_t triangleIndex; ///< Triangle index within the mesh
+    };
+
+    std::vector<Node> nodes;            ///< Nodes with adjacent children, the root first
+    std::vector<Triangle> triangles;    ///< Triangles in leaf order
+
+    /**
+     * @brief Finds the cheapest split of a node with the surface area heuristic
+     *
+     * @param node The node to split
+     * @param centroids Centroid of every triangle, in leaf order
+     * @param axis Set to the axis of the split
+     * @param splitPosition Set to the centroid coordinate separating both children
+     * @return The cost of the split relative to a triangle test, infinity if no split exists
+     */
+    float findSplit(const Node& node, const std::vector<glm::vec3>& centroids, int& axis, float& splitPosition) const;
+
+    /**
+     * @brief Grows a node's box around its triangles
+     *
+     * @param node The node to fit
+     */
+    void fitBounds(Node& node) const;
+
+    /**
+     * @brief Intersects a ray with a node's box
+     *
+     * @param node The node to test
+     * @param origin Origin of the ray
+     * @param inverseDirection Reciprocal of each component of the ray direction
+     * @param maxDistance Hits farther than this are ignored
+     * @return The entry distance, infinity if the box is missed
+     */
+    static float intersectBox(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance);
+
+    /**
+     * @brief Intersects a ray with a triangle using the Möller-Trumbore algorithm
+     *
+     * @param triangle The triangle to test
+     * @param origin Origin of the ray
+     * @param direction Direction of the ray
+     * @param maxDistance Hits farther than this are ignored
+     * @return The hit distance, infinity if the triangle is missed
+     */
+    static float intersectTriangle(const Triangle& triangle, const glm::vec3& origin, const glm::vec3& direction, float maxDistance);
+
+public:
+    /**
+     * @brief Builds the hierarchy over the full resolution triangles of a set of meshes
+     *
+     * @param meshes The meshes, with their float vertices still present
+     */
+    void build(const std::vector<MeshData>& meshes);
+
+    /**
+     * @brief Finds the closest triangle hit by a ray
+     *
+     * @param origin Origin of the ray
+     * @param direction Direction of the ray, distances are expressed in its length
+     * @param maxDistance Hits farther than this are ignored
+     * @return The closest hit, its positions are left unset
+     */
+    RayHit intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance = INFINITY) const;
+
+    /**
+     * @brief Finds the closest triangle hit by a ray by testing every triangle
+     *
+     * Only meant to validate the hierarchy.
+     *
+     * @param origin Origin of the ray
+     * @param direction Direction of the ray
+     * @return The closest hit, its positions are left unset
+     */
+    RayHit intersectBruteForce(const glm::vec3& origin, const glm::vec3& direction) const;
+
+    /**
+     * @brief Checks whether the hierarchy holds any triangle
+     *
+     * @return True if the hierarchy was built from at least one triangle
+     */
+    bool empty() const { return triangles.empty(); }
+
+    /**
+     * @brief Gets the number of nodes of the hierarchy
+     *
+     * @return The node count
+     */
+    size_t getNodeCount() const { return nodes.size(); }
+
+    /**
+     * @brief Gets the number of triangles in the hierarchy
+     *
+     * @return The triangle count
+     */
+    size_t getTriangleCount() const { return triangles.size(); }
+
+    /**
+     * @brief Gets the memory used by the hierarchy
+     *
+     * @return The size of the nodes and triangles in bytes
+     */
+    size_t getMemoryBytes() const { return nodes.size() * sizeof(Node) + triangles.size() * sizeof(Triangle); }
+};
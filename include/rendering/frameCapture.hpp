@@ -0,0 +1,143 @@
+#pragma once
+
+#include <future>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "rendering/gpuResource.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @class FrameCapture
+ * @brief Records rendered frames to a numbered PNG sequence without stalling the GL thread
+ *
+ * Each frame is read back into the next pixel buffer of a ring, asynchronously, and fenced.
+ * Frames whose fence has signaled are handed to the shared thread pool, whose workers encode
+ * them straight from the persistently mapped buffer. A buffer is only reused once its frame is
+ * written, so the GL thread waits only when the whole ring is still in flight. The time spent
+ * on the GL thread is measured per frame against CAPTURE_OVERHEAD_BUDGET_MS.
+ */
+class FrameCapture {
+private:
+    /**
+     * @brief A pixel buffer of the ring and the frame it holds
+     */
+    struct Slot {
+        GlBuffer buffer;                        ///< Pixel buffer the frame is read back into
+        const unsigned char* pixels = nullptr;  ///< Persistent read mapping of the buffer
+        GLsync fence = nullptr;                 ///< Signals the end of the readback, null once handed to an encoder
+        std::future<bool> encoded;              ///< Result of the encoding, valid while a worker uses the buffer
+        int frame = -1;                         ///< Number of the frame held
+    };
+
+    std::string directory;          ///< Directory the images are written to
+    int width = 0;                  ///< Width of the captured region in pixels
+    int height = 0;                 ///< Height of the captured region in pixels
+    std::vector<Slot> slots;        ///< The ring of pixel buffers
+    size_t nextSlot = 0;            ///< Slot the next frame is read back into
+    bool valid = false;             ///< Set once the buffers are mapped and the directory exists
+
+    int capturedFrames = 0;         ///< Frames read back so far
+    int writtenFrames = 0;          ///< Frames encoded and written
+    int failedFrames = 0;           ///< Frames that could not be written
+    double totalOverhead = 0.0;     ///< Time spent on the GL thread over all frames, in milliseconds
+    double maxOverhead = 0.0;       ///< Longest time spent on the GL thread by a frame, in milliseconds
+    double ringWait = 0.0;          ///< Part of the overhead spent waiting for a busy slot, in milliseconds
+    int overBudgetFrames = 0;       ///< Frames whose overhead exceeded CAPTURE_OVERHEAD_BUDGET_MS
+
+    /**
+     * @brief Hands a slot whose readback is done to an encoder
+     *
+     * @param slot The slot, with a fence
+     * @param wait Block until the fence signals instead of requiring it to have signaled
+     */
+    void encode(Slot& slot, bool wait);
+
+    /**
+     * @brief Waits for the encoding of a slot and records its result
+     *
+     * @param slot The slot, with a valid encoding result
+     */
+    void collect(Slot& slot);
+
+public:
+    /**
+     * @brief Creates the ring of pixel buffers and the output directory
+     *
+     * @param directory Directory the images are written to
+     * @param width Width of the captured region in pixels
+     * @param height Height of the captured region in pixels
+     * @param ringSize Number of pixel buffers in the ring
+     */
+    FrameCapture(const std::string& directory, int width, int height, size_t ringSize = CAPTURE_RING_SIZE);
+
+    /**
+     * @brief Finishes the frames in flight
+     */
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /**
+     * @brief Checks whether the capture could be set up
+     *
+     * @return True if frames can be captured
+     */
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief Reads back the current frame and hands finished readbacks to the encoders
+     *
+     * Call once the frame is drawn, before the buffers are swapped.
+     *
+     * @param framebuffer Framebuffer to read from, 0 for the back buffer of the window
+     */
+    void capture(GLuint framebuffer);
+
+    /**
+     * @brief Waits until every captured frame is written, then releases the buffers
+     */
+    void finish();
+
+    /**
+     * @brief Prints the number of frames written and the overhead per frame
+     */
+    void printReport() const;
+
+    /**
+     * @brief Gets the number of frames read back
+     *
+     * @return The frame count
+     */
+    int getCapturedFrames() const { return capturedFrames; }
+
+    /**
+     * @brief Gets the number of frames written so far
+     *
+     * @return The frame count
+     */
+    int getWrittenFrames() const { return writtenFrames; }
+
+    /**
+     * @brief Gets the number of frames that could not be written
+     *
+     * @return The frame count
+     */
+    int getFailedFrames() const { return failedFrames; }
+
+    /**
+     * @brief Gets the average time the capture added to a frame on the GL thread
+     *
+     * @return Time in milliseconds
+     */
+    double getAverageOverhead() const { return capturedFrames ? totalOverhead / capturedFrames : 0.0; }
+
+    /**
+     * @brief Gets the longest time the capture added to a frame on the GL thread
+     *
+     * @return Time in milliseconds
+     */
+    double getMaxOverhead() const { return maxOverhead; }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/**
+ * @class Frustum
+ * @brief The six clipping planes of a view volume, used for visibility tests
+ * 
+ * Planes are extracted from a combined matrix (Gribb and Hartmann), so they live in the space the
+ * matrix transforms from: projection * view gives world space planes, projection * view * model
+ * gives planes in the model's local space, where mesh bounds can be tested without transforming them.
+ */
+class Frustum {
+private:
+    glm::vec4 planes[6]; ///< Left, right, bottom, top, near and far planes, normals pointing inside
+
+public:
+    /**
+     * @brief Extracts the frustum planes of a matrix
+     * 
+     * @param matrix The combined projection matrix, e.g. projection * view
+     */
+    Frustum(const glm::mat4& matrix);
+
+    /**
+     * @brief Checks whether a sphere is at least partially inside the frustum
+     * 
+     * @param center Center of the sphere
+     * @param radius Radius of the sphere
+     * @return False if the sphere is entirely outside one of the planes
+     */
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+    /**
+     * @brief Checks whether an axis-aligned box is at least partially inside the frustum
+     * 
+     * Conservative: a box outside near a frustum corner may still be reported as intersecting.
+     * 
+     * @param minBounds Minimum corner of the box
+     * @param maxBounds Maximum corner of the box
+     * @return False if the box is entirely outside one of the planes
+     */
+    bool intersectsBox(const glm::vec3& minBounds, const glm::vec3& maxBounds) const;
+};
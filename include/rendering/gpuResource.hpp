@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <GL/glew.h>
+
+/**
+ * @enum GpuMemoryCategory
+ * @brief Kinds of GPU allocations accounted by the GpuMemoryRegistry
+ */
+enum class GpuMemoryCategory {
+    Textures,           ///< Texture images and their mipmaps
+    VertexBuffers,      ///< Per-vertex and per-instance attribute buffers
+    IndexBuffers,       ///< Element buffers
+    UniformBuffers,     ///< Uniform blocks shared between programs
+    RenderTargets,      ///< Offscreen colour and depth attachments
+    ReadbackBuffers,    ///< Pixel buffers frames are read back into
+    Count               ///< Number of categories, also marks an untracked handle
+};
+
+/**
+ * @class GpuMemoryRegistry
+ * @brief Live account of the GPU memory held by the tracked handles, by category
+ *
+ * Sizes are recorded by the handles when their storage is allocated and removed when they
+ * are deleted, so the totals always describe what is resident. Texture sizes are estimated
+ * from their dimensions, as drivers do not report their padding. Must only be used from the
+ * thread owning the GL context, like the handles themselves.
+ */
+class GpuMemoryRegistry {
+private:
+    size_t bytes[(size_t) GpuMemoryCategory::Count] = {};   ///< Bytes held in each category
+    size_t objects[(size_t) GpuMemoryCategory::Count] = {}; ///< Tracked objects in each category
+
+public:
+    /**
+     * @brief Gets the registry shared by the whole process
+     *
+     * @return The shared registry
+     */
+    static GpuMemoryRegistry& getShared();
+
+    /**
+     * @brief Records an allocation
+     *
+     * @param category Kind of the allocation
+     * @param size Size in bytes
+     */
+    void add(GpuMemoryCategory category, size_t size);
+
+    /**
+     * @brief Records that an allocation was released
+     *
+     * @param category Kind of the allocation
+     * @param size Size in bytes, as recorded when added
+     */
+    void remove(GpuMemoryCategory category, size_t size);
+
+    /**
+     * @brief Gets the memory held in a category
+     *
+     * @param category The category
+     * @return Size in bytes
+     */
+    size_t getBytes(GpuMemoryCategory category) const { return bytes[(size_t) category]; }
+
+    /**
+     * @brief Gets the number of objects holding memory in a category
+     *
+     * @param category The category
+     * @return The object count
+     */
+    size_t getObjectCount(GpuMemoryCategory category) const { return objects[(size_t) category]; }
+
+    /**
+     * @brief Gets the memory held over all categories
+     *
+     * @return Size in bytes
+     */
+    size_t getTotalBytes() const;
+};
+
+/**
+ * @brief Creation and deletion of OpenGL buffer names
+ */
+struct GlBufferTraits {
+    static GLuint create() { GLuint id = 0; glGenBuffers(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteBuffers(1, &id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL vertex array names
+ */
+struct GlVertexArrayTraits {
+    static GLuint create() { GLuint id = 0; glGenVertexArrays(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteVertexArrays(1, &id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL texture names
+ */
+struct GlTextureTraits {
+    static GLuint create() { GLuint id = 0; glGenTextures(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteTextures(1, &id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL framebuffer names
+ */
+struct GlFramebufferTraits {
+    static GLuint create() { GLuint id = 0; glGenFramebuffers(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteFramebuffers(1, &id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL renderbuffer names
+ */
+struct GlRenderbufferTraits {
+    static GLuint create() { GLuint id = 0; glGenRenderbuffers(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteRenderbuffers(1, &id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL query names
+ */
+struct GlQueryTraits {
+    static GLuint create() { GLuint id = 0; glGenQueries(1, &id); return id; }
+    static void destroy(GLuint id) { glDeleteQueries(1, &id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL program objects
+ */
+struct GlProgramTraits {
+    static GLuint create() { return glCreateProgram(); }
+    static void destroy(GLuint id) { glDeleteProgram(id); }
+};
+
+/**
+ * @brief Creation and deletion of OpenGL shader objects
+ */
+struct GlShaderTraits {
+    static GLuint create(GLenum type) { return glCreateShader(type); }
+    static void destroy(GLuint id) { glDeleteShader(id); }
+};
+
+/**
+ * @class GlHandle
+ * @brief Move-only owner of an OpenGL object
+ *
+ * The object is deleted when the handle is destroyed or reset, so it can neither leak nor be
+ * deleted twice by copies. Handles whose storage size is known report it to the
+ * GpuMemoryRegistry through track(). Must be created and destroyed on the thread owning the
+ * GL context, and released before the context is destroyed.
+ *
+ * @tparam Traits Provides the static create and destroy functions of the object type
+ */
+template <typename Traits>
+class GlHandle {
+private:
+    GLuint id = 0;                                          ///< OpenGL name, 0 when empty
+    GpuMemoryCategory category = GpuMemoryCategory::Count;  ///< Category of the tracked storage, Count if untracked
+    size_t bytes = 0;                                       ///< Tracked storage size
+
+    /**
+     * @brief Removes the tracked storage from the registry
+     */
+    void untrack() {
+        if (category == GpuMemoryCategory::Count) return;
+
+        GpuMemoryRegistry::getShared().remove(category, bytes);
+        category = GpuMemoryCategory::Count;
+        bytes = 0;
+    }
+
+public:
+    /**
+     * @brief Creates an empty handle
+     */
+    GlHandle() = default;
+
+    /**
+     * @brief Creates a new OpenGL object
+     *
+     * @param args Arguments of the object creation, such as the shader type
+     * @return A handle owning the new object
+     */
+    template <typename... Args>
+    static GlHandle create(Args... args) {
+        GlHandle handle;
+        handle.id = Traits::create(args...);
+        return handle;
+    }
+
+    ~GlHandle() { reset(); }
+
+    GlHandle(const GlHandle&) = delete;
+    GlHandle& operator=(const GlHandle&) = delete;
+
+    GlHandle(GlHandle&& other) noexcept
+        : id(std::exchange(other.id, 0)), category(std::exchange(other.category, GpuMemoryCategory::Count)), bytes(std::exchange(other.bytes, 0)) {}
+
+    GlHandle& operator=(GlHandle&& other) noexcept {
+        if (this != &other) {
+            reset();
+            id = std::exchange(other.id, 0);
+            category = std::exchange(other.category, GpuMemoryCategory::Count);
+            bytes = std::exchange(other.bytes, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Deletes the object, leaving the handle empty
+     */
+    void reset() {
+        if (id == 0) return;
+
+        untrack();
+        Traits::destroy(id);
+        id = 0;
+    }
+
+    /**
+     * @brief Records the size of the object's storage, replacing any size recorded before
+     *
+     * Call after each allocation of the storage, such as glBufferData or glTexImage2D.
+     *
+     * @param newCategory Kind of the storage
+     * @param newBytes Size of the storage in bytes
+     */
+    void track(GpuMemoryCategory newCategory, size_t newBytes) {
+        untrack();
+        category = newCategory;
+        bytes = newBytes;
+        GpuMemoryRegistry::getShared().add(category, bytes);
+    }
+
+    /**
+     * @brief Gets the OpenGL name of the object
+     *
+     * @return The name, 0 if the handle is empty
+     */
+    GLuint get() const { return id; }
+
+    /**
+     * @brief Gets the tracked size of the object's storage
+     *
+     * @return Size in bytes, 0 if untracked
+     */
+    size_t getBytes() const { return bytes; }
+
+    /**
+     * @brief Checks whether the handle owns an object
+     */
+    explicit operator bool() const { return id != 0; }
+};
+
+using GlBuffer = GlHandle<GlBufferTraits>;
+using GlVertexArray = GlHandle<GlVertexArrayTraits>;
+using GlTexture = GlHandle<GlTextureTraits>;
+using GlFramebuffer = GlHandle<GlFramebufferTraits>;
+using GlRenderbuffer = GlHandle<GlRenderbufferTraits>;
+using GlQuery = GlHandle<GlQueryTraits>;
+using GlProgram = GlHandle<GlProgramTraits>;
+using GlShader = GlHandle<GlShaderTraits>;
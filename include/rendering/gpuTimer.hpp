@@ -0,0 +1,88 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <GL/glew.h>
+
+#include "rendering/gpuResource.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @class GpuTimer
+ * @brief Measures GPU time between two points of the command stream without stalling
+ *
+ * Every begin() / end() pair records a GL_TIME_ELAPSED query. Queries are kept in a ring and
+ * their results are read once available, some frames later, so the CPU does not wait for the
+ * GPU to catch up. Only when every query of the ring is still pending does begin() wait for the
+ * oldest one. Results come out in the order they were recorded and are kept until taken with
+ * takeResult(). Only one timer can be running
+ * at a time, as OpenGL allows a single active GL_TIME_ELAPSED query.
+ */
+class GpuTimer {
+private:
+    std::vector<GlQuery> queries;   ///< The ring of query objects
+    size_t nextQuery = 0;           ///< Query the next begin() records into
+    size_t pendingQueries = 0;      ///< Queries recorded but not read, ending just before nextQuery
+    std::deque<double> results;     ///< Times read back but not yet taken, oldest first, in milliseconds
+    double latestTime = 0.0;        ///< Most recent time read back, in milliseconds
+
+    /**
+     * @brief Reads the result of the oldest pending query
+     *
+     * @param wait Block until the result is available
+     * @return True if a result was read
+     */
+    bool readOldest(bool wait);
+
+public:
+    /**
+     * @brief Creates the ring of queries
+     *
+     * @param latency Number of queries in the ring, the frames a result may arrive late
+     */
+    explicit GpuTimer(size_t latency = GPU_TIMER_LATENCY);
+
+    /**
+     * @brief Starts timing the commands that follow
+     */
+    void begin();
+
+    /**
+     * @brief Starts timing the commands that follow, unless every query of the ring is pending
+     *
+     * Never waits for the GPU, the commands are simply not timed when no query is free.
+     *
+     * @return True if timing started and end() must be called
+     */
+    bool tryBegin();
+
+    /**
+     * @brief Stops timing
+     */
+    void end();
+
+    /**
+     * @brief Reads the results that became available, without waiting
+     */
+    void update();
+
+    /**
+     * @brief Waits for every pending result
+     */
+    void finish();
+
+    /**
+     * @brief Takes the oldest result read back
+     *
+     * @param milliseconds Set to the GPU time of the measured commands
+     * @return True if a result was available
+     */
+    bool takeResult(double& milliseconds);
+
+    /**
+     * @brief Gets the most recent result read back
+     *
+     * @return GPU time in milliseconds, 0 before the first result
+     */
+    double getLatestTime() const { return latestTime; }
+};
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <cfloat>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
 
+#include "rendering/gpuResource.hpp"
 #include "shader/shaderProgram.hpp"
+#include "utils/constants.hpp"
 
 /**
  * @struct Vertex
@@ -19,6 +23,58 @@ struct Vertex {
     glm::vec2 texCoords; ///< The texture coordinates of the vertex.
 };
 
+/**
+ * @struct PackedVertex
+ * @brief Compact 16 byte vertex layout, half the size of Vertex.
+ * 
+ * Positions are signed normalized 16-bit values relative to the mesh bounds, normals are
+ * octahedral encoded into two signed normalized 16-bit values, and texture coordinates are
+ * either unsigned normalized 16-bit values or half floats when they leave the [0, 1] range.
+ */
+struct PackedVertex {
+    int16_t position[4]; ///< Quantized position, the fourth component only pads to 8 bytes.
+    int16_t normal[2]; ///< Octahedral encoded normal.
+    uint16_t texCoords[2]; ///< Texture coordinates as unorm16 or half floats.
+};
+
+/**
+ * @struct VertexQuantization
+ * @brief Parameters needed by the vertex shader to decode a PackedVertex.
+ */
+struct VertexQuantization {
+    glm::vec3 positionScale = glm::vec3(1.0f); ///< Half extent of the mesh bounds.
+    glm::vec3 positionOffset = glm::vec3(0.0f); ///< Center of the mesh bounds.
+    bool halfTexCoords = false; ///< Whether texture coordinates are half floats instead of unorm16.
+};
+
+/**
+ * @struct PackedVertexData
+ * @brief Packed copy of a mesh's vertices along with its decode parameters.
+ */
+struct PackedVertexData {
+    std::vector<PackedVertex> vertices; ///< The packed vertices, in the same order as the float ones.
+    VertexQuantization quantization; ///< Parameters to decode the packed vertices.
+};
+
+/**
+ * @struct MeshLod
+ * @brief A level of detail of a mesh, a range of its index buffer.
+ */
+struct MeshLod {
+    GLuint indexOffset = 0; ///< First index of the level.
+    GLsizei indexCount = 0; ///< Number of indices of the level.
+    float error = 0.0f; ///< Largest distance to the full resolution surface, in model units.
+};
+
+/**
+ * @struct MeshLodChain
+ * @brief Simplified levels of a mesh, sharing the vertices of the full resolution level.
+ */
+struct MeshLodChain {
+    std::vector<MeshLod> levels; ///< The simplified levels, coarser last, offsets index into indices.
+    std::vector<GLuint> indices; ///< Index data of every simplified level, concatenated.
+};
+
 /**
  * @struct Texture
  * @brief Texture data structure for the Mesh class.
@@ -32,6 +88,24 @@ struct Texture {
     std::string path; ///< The file path to the texture image.
 };
 
+/**
+ * @struct MeshData
+ * @brief CPU-side geometry and material bindings of a mesh before upload.
+ * 
+ * Holds everything needed to build a Mesh without touching the model file again. Textures
+ * only carry their type and path at this stage, their OpenGL IDs are resolved on upload.
+ */
+struct MeshData {
+    std::vector<Vertex> vertices; ///< The vertex data of the mesh.
+    std::vector<GLuint> indices; ///< The index data of the mesh.
+    std::vector<Texture> textures; ///< The textures bound to the mesh, IDs not yet resolved.
+    float shininess = DEFAULT_SHININESS; ///< The shininess of the mesh's material.
+    PackedVertexData packed; ///< Packed copy of the vertices, empty unless packed vertices are enabled.
+    MeshLodChain lodChain; ///< Simplified levels of detail, empty unless LODs are generated.
+    glm::vec3 minBounds = glm::vec3(FLT_MAX); ///< The minimum corner of the mesh in model space.
+    glm::vec3 maxBounds = glm::vec3(-FLT_MAX); ///< The maximum corner of the mesh in model space.
+};
+
 /**
  * @class Mesh
  * @brief Manages a mesh object.
@@ -46,41 +120,61 @@ class Mesh {
          * 
          * Manages vertex attribute configurations and binds VBOs and EBOs for rendering.
          */
-        GLuint VAO;
+        GlVertexArray VAO;
 
         /**
          * @brief Vertex Buffer Object (VBO).
          * 
          * Stores vertex data (positions, normals, and texture coordinates) in GPU memory for efficient access.
          */
-        GLuint VBO;
+        GlBuffer VBO;
 
         /**
          * @brief Element Buffer Object (EBO).
          * 
          * Holds indices for indexed drawing, optimizing memory usage and performance during rendering.
          */
-        GLuint EBO;
+        GlBuffer EBO;
 
-        std::vector<Vertex> vertices; ///< A vector containing the mesh's vertex data.
-        std::vector<GLuint> indices; ///< A vector containing the mesh's index data.
+        std::vector<Vertex> vertices; ///< A vector containing the mesh's vertex data, empty once released.
+        std::vector<GLuint> indices; ///< A vector containing the mesh's index data, empty once released.
         std::vector<Texture> textures; ///< A vector containing the textures applied to the mesh.
 
+        GLsizei indexCount = 0; ///< Number of indices uploaded to the EBO, kept when the CPU copy is released.
+        GLenum indexType = GL_UNSIGNED_INT; ///< Type of the indices in the EBO, GL_UNSIGNED_SHORT when the vertices fit.
+
+        std::vector<MeshLod> lods; ///< Levels of detail stored in the EBO, level 0 being the full mesh.
+        size_t currentLod = 0; ///< Level drawn by drawElements().
+
+        glm::vec3 minBounds = glm::vec3(-FLT_MAX); ///< Minimum corner of the mesh in model space, unbounded until set.
+        glm::vec3 maxBounds = glm::vec3(FLT_MAX); ///< Maximum corner of the mesh in model space, unbounded until set.
+        glm::vec3 boundingCenter = glm::vec3(0.0f); ///< Center of the mesh's bounding sphere in model space.
+        float boundingRadius = FLT_MAX; ///< Radius of the mesh's bounding sphere, unbounded until set.
+
+        bool packedLayout = false; ///< Whether the VBO holds PackedVertex instead of Vertex data.
+        VertexQuantization quantization; ///< Decode parameters of the packed layout, identity otherwise.
+
         float shininess = 32.0f; ///< The shininess of the material applied to the mesh.
+        uint64_t materialKey = 0; ///< Hash of the textures and shininess, equal for meshes sharing a material.
 
         /**
          * @brief Initializes the VAO, VBO, and EBO for the mesh.
          * 
          * This method sets up OpenGL buffers and vertex attribute pointers for positions, normals, 
-         * and texture coordinates, allowing the mesh to be rendered efficiently.
+         * and texture coordinates, allowing the mesh to be rendered efficiently. Indices are stored
+         * as 16-bit values whenever every vertex can be addressed with them.
+         * 
+         * @param packed Packed vertices uploaded instead of the float ones when not empty.
+         * @param lodChain Simplified levels appended to the EBO after the full resolution indices.
          */
-        void setupMesh();
+        void setupMesh(const PackedVertexData& packed = PackedVertexData(), const MeshLodChain& lodChain = MeshLodChain());
 
     public:
         /**
          * @brief Constructs a Mesh object with vertex data, index data, and textures.
          * 
          * Initializes the mesh and sets up the necessary OpenGL buffers for efficient rendering.
+         * The geometry is moved into the mesh, pass temporaries or std::move to avoid copies.
          * 
          * @param vertices A vector containing the vertex data (positions, normals, texCoords).
          * @param indices A vector containing the index data for indexed drawing.
@@ -92,29 +186,206 @@ class Mesh {
          * @brief Constructs a Mesh object with vertex data, index data, textures, and shininess.
          * 
          * Initializes the mesh, sets the shininess property, and sets up the necessary OpenGL buffers.
+         * The geometry is moved into the mesh, pass temporaries or std::move to avoid copies.
          * 
          * @param vertices A vector containing the vertex data (positions, normals, texCoords).
          * @param indices A vector containing the index data for indexed drawing.
          * @param textures A vector containing the textures applied to the mesh.
          * @param shininess The shininess of the material.
+         * @param packed Packed copy of the vertices to upload instead of the float ones, if not empty.
+         * @param lodChain Simplified levels of detail drawn from the same vertex buffer, if any.
+         */
+        Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures, float shininess, 
+             const PackedVertexData& packed = PackedVertexData(), const MeshLodChain& lodChain = MeshLodChain());
+
+        /**
+         * @brief Binds the textures of the mesh and sets its material uniforms.
+         * 
+         * Texture units already holding the right texture are left alone, which lets a render
+         * queue skip the binds shared with the previous mesh.
+         * 
+         * @param shader The shader program receiving the material uniforms.
+         * @param boundTextures Texture bound to each unit, updated with the binds made.
+         * @return The number of texture binds and uniform uploads issued.
+         */
+        size_t bindMaterial(ShaderProgram& shader, std::vector<GLuint>& boundTextures) const;
+
+        /**
+         * @brief Issues the draw calls of the current level of detail.
+         * 
+         * The mesh's VAO must be bound and its uniforms set.
+         * 
+         * @param instanceCount Number of transforms to read from the instance buffer, 0 to draw the mesh once without it.
+         * @param instancedDraw True to draw every instance in one call, false for one call per instance.
+         */
+        void drawElements(GLsizei instanceCount, bool instancedDraw) const;
+
+        /**
+         * @brief Sources the per-instance transforms of the mesh from a buffer.
+         * 
+         * The buffer holds one glm::mat4 per instance, bound to attribute locations 3 to 6 with a divisor of 1.
+         * 
+         * @param buffer The instance buffer, owned by the caller.
+         */
+        void setInstanceBuffer(GLuint buffer);
+
+        /**
+         * @brief Gets the textures applied to the mesh.
+         * 
+         * @return The textures, in texture unit order.
+         */
+        const std::vector<Texture>& getTextures() const { return textures; }
+
+        /**
+         * @brief Gets the vertex array object of the mesh.
+         * 
+         * @return The VAO name.
+         */
+        GLuint getVAO() const { return VAO.get(); }
+
+        /**
+         * @brief Gets the key identifying the mesh's material.
+         * 
+         * @return A hash of the textures and shininess.
+         */
+        uint64_t getMaterialKey() const { return materialKey; }
+
+        /**
+         * @brief Gets the decode parameters of the vertex positions.
+         * 
+         * @return The quantization of the packed layout, identity for float vertices.
          */
-        Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures, float shininess);
+        const VertexQuantization& getQuantization() const { return quantization; }
 
         /**
-         * @brief Destructor for the Mesh class.
+         * @brief Checks whether the VBO holds packed vertices.
          * 
-         * Cleans up the OpenGL resources by deleting the VAO, VBO, EBO, and textures associated with the mesh.
+         * @return True for the 16 byte layout with octahedral normals.
          */
-        ~Mesh();
+        bool isPackedLayout() const { return packedLayout; }
 
         /**
-         * @brief Draws the mesh using the provided shader program.
+         * @brief Frees the CPU copy of the vertex and index data.
          * 
-         * This method binds the appropriate textures and sets shader uniforms for material properties 
-         * like diffuse and specular textures, shininess, and texture counts. It then draws the mesh 
-         * using OpenGL's `glDrawElements` function.
+         * The mesh keeps drawing from its GPU buffers. Features needing CPU-side geometry
+         * will find it empty afterwards.
+         */
+        void releaseGeometry();
+
+        /**
+         * @brief Checks whether the CPU copy of the geometry is still available.
+         * 
+         * @return True if the vertex and index data were not released.
+         */
+        bool hasGeometry() const { return !vertices.empty(); }
+
+        /**
+         * @brief Gets the CPU copy of the vertex data.
+         * 
+         * @return The vertices, empty once released.
+         */
+        const std::vector<Vertex>& getVertices() const { return vertices; }
+
+        /**
+         * @brief Gets the CPU copy of the index data.
+         * 
+         * @return The indices, empty once released.
+         */
+        const std::vector<GLuint>& getIndices() const { return indices; }
+
+        /**
+         * @brief Gets the size of the index data on the GPU, every level of detail included.
+         * 
+         * @return The EBO size in bytes.
+         */
+        size_t getIndexBytes() const {
+            size_t count = lods.empty() ? size_t(indexCount) : lods.back().indexOffset + size_t(lods.back().indexCount);
+            return count * (indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+        }
+
+        /**
+         * @brief Checks whether a mesh can be drawn with 16-bit indices.
+         * 
+         * @param vertexCount Number of vertices of the mesh.
+         * @return True if every vertex can be addressed by a 16-bit index.
+         */
+        static bool fitsShortIndices(size_t vertexCount) { return vertexCount <= MAX_SHORT_INDEX_VERTICES; }
+
+        /**
+         * @brief Selects the level of detail drawn from its projected error.
+         * 
+         * The coarsest level whose simplification error stays under the pixel threshold is chosen.
+         * Switching away from the current level requires crossing the threshold by LOD_HYSTERESIS,
+         * so levels do not alternate when the projected size sits right at the threshold.
+         * 
+         * @param pixelsPerUnit Screen pixels covered by one model unit at the mesh's distance.
+         * @param pixelError Largest simplification error allowed on screen, in pixels, 0 forces the full mesh.
+         */
+        void selectLod(float pixelsPerUnit, float pixelError);
+
+        /**
+         * @brief Gets the number of levels of detail.
+         * 
+         * @return The level count, 1 when only the full mesh exists.
+         */
+        size_t getLodCount() const { return lods.size(); }
+
+        /**
+         * @brief Gets the level of detail drawn.
+         * 
+         * @return The current level, 0 being the full mesh.
+         */
+        size_t getCurrentLod() const { return currentLod; }
+
+        /**
+         * @brief Gets the number of triangles drawn at the current level of detail.
+         * 
+         * @return The triangle count of the current level.
+         */
+        size_t getDrawnTriangles() const { return lods.empty() ? 0 : size_t(lods[currentLod].indexCount) / 3; }
+
+        /**
+         * @brief Gets the number of triangles of the full resolution mesh.
+         * 
+         * @return The triangle count of level 0.
+         */
+        size_t getTriangleCount() const { return size_t(indexCount) / 3; }
+
+        /**
+         * @brief Sets the bounds of the mesh used for visibility tests.
+         * 
+         * The bounding sphere is derived from the box. Meshes without bounds are never culled.
+         * 
+         * @param newMinBounds The minimum corner of the mesh in model space.
+         * @param newMaxBounds The maximum corner of the mesh in model space.
+         */
+        void setBounds(const glm::vec3& newMinBounds, const glm::vec3& newMaxBounds);
+
+        /**
+         * @brief Gets the minimum corner of the mesh.
+         * 
+         * @return The minimum corner in model space.
+         */
+        const glm::vec3& getMinBounds() const { return minBounds; }
+
+        /**
+         * @brief Gets the maximum corner of the mesh.
+         * 
+         * @return The maximum corner in model space.
+         */
+        const glm::vec3& getMaxBounds() const { return maxBounds; }
+
+        /**
+         * @brief Gets the center of the mesh's bounding sphere.
+         * 
+         * @return The center in model space.
+         */
+        const glm::vec3& getBoundingCenter() const { return boundingCenter; }
+
+        /**
+         * @brief Gets the radius of the mesh's bounding sphere.
          * 
-         * @param shader The shader program used for rendering the mesh.
+         * @return The radius in model units.
          */
-        void draw(ShaderProgram& shader);
+        float getBoundingRadius() const { return boundingRadius; }
 };
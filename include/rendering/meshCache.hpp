@@ -0,0 +1,156 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+struct ModelData;
+
+#define MESH_CACHE_MAGIC 0x434D5841u   // "AXMC"
+#define MESH_CACHE_VERSION 6u
+#define MESH_CACHE_EXTENSION ".meshcache"
+
+/*
+Mesh cache file layout (native endianness, every section 4 byte aligned):
+
+MeshCacheHeader
+material library path chars, padding
+for each mesh:
+    MeshCacheMeshHeader
+    for each texture: uint32 type length, uint32 path length, type chars, path chars, padding
+    Vertex[vertexCount]
+    GLuint[indexCount]
+    MeshCacheLod[lodCount]
+    GLuint[lodIndexCount]
+*/
+
+/**
+ * @struct MeshCacheHeader
+ * @brief Header at the start of every mesh cache file
+ * 
+ * Identifies the format version and the source and material library files the cache was
+ * built from, so the cache can be invalidated when either changes.
+ */
+struct MeshCacheHeader {
+    uint32_t magic;             ///< Always MESH_CACHE_MAGIC
+    uint32_t version;           ///< Format version, MESH_CACHE_VERSION when written
+    int64_t sourceModifiedTime; ///< Last write time of the source file
+    uint64_t sourceSize;        ///< Size of the source file in bytes
+    uint64_t sourceHash;        ///< Hash of the source file content
+    uint32_t meshCount;         ///< Number of mesh records following the header
+    uint32_t needFlip;          ///< Resolved UV flip decision
+    float minBounds[3];         ///< Minimum corner of the model
+    float maxBounds[3];         ///< Maximum corner of the model
+    uint32_t importFlags;       ///< Assimp post-processing flags of the import profile used
+    uint32_t sourceMeshCount;   ///< Number of meshes before the profile's optimization passes
+    uint64_t sourceVertexCount; ///< Number of vertices before the profile's optimization passes
+    uint64_t sourceIndexCount;  ///< Number of indices before the profile's optimization passes
+    uint64_t sourceTransformedVertices; ///< Simulated vertex cache misses before the optimization passes
+    uint32_t meshOptimized;     ///< Whether the MeshOptimizer passes were run
+    uint32_t indicesSplit;      ///< Whether meshes were split to fit 16-bit indices
+    uint32_t lodsGenerated;     ///< Whether the levels of detail were generated
+    uint32_t materialPathLength; ///< Length of the material library path following the header, 0 without one
+    int64_t materialModifiedTime; ///< Last write time of the material library
+    uint64_t materialSize;      ///< Size of the material library in bytes
+    uint64_t materialHash;      ///< Hash of the material library content
+};
+
+/**
+ * @struct MeshCacheMeshHeader
+ * @brief Header of a single mesh record within a mesh cache file
+ */
+struct MeshCacheMeshHeader {
+    uint32_t vertexCount;       ///< Number of vertices in the record
+    uint32_t indexCount;        ///< Number of indices in the record
+    uint32_t textureCount;      ///< Number of texture bindings in the record
+    float shininess;            ///< Shininess of the mesh's material
+    uint32_t lodCount;          ///< Number of simplified levels of detail in the record
+    uint32_t lodIndexCount;     ///< Number of indices of every simplified level, concatenated
+    float minBounds[3];         ///< Minimum corner of the mesh
+    float maxBounds[3];         ///< Maximum corner of the mesh
+};
+
+/**
+ * @struct MeshCacheLod
+ * @brief A simplified level of detail within a mesh record
+ */
+struct MeshCacheLod {
+    uint32_t indexOffset;       ///< First index of the level within the record's LOD indices
+    uint32_t indexCount;        ///< Number of indices of the level
+    float error;                ///< Simplification error of the level, in model units
+    uint32_t reserved;          ///< Keeps the record 16 bytes
+};
+
+/**
+ * @class MeshCache
+ * @brief Binary on-disk cache of imported model geometry
+ * 
+ * After a model is imported through Assimp, its vertices, indices, material bindings, bounds
+ * and UV flip decision are written to a versioned binary file. Later loads map that file and
+ * skip the import entirely. An entry is only used while the modification time and size of the
+ * source file and of its material library match, or when their content hash still matches
+ * after the time changed.
+ */
+class MeshCache {
+private:
+    /**
+     * @brief Builds the path of the cache file for a model file
+     * 
+     * Each import profile and combination of optimizer, split and LOD settings has its own cache
+     * file so switching does not evict the others. The name holds a hash of the canonical model
+     * path, so models sharing a file name in different directories do not share a file.
+     * 
+     * @param modelPath Path to the model file
+     * @param data The model data whose profile and processing settings select the file
+     * @return Path to the cache file within CACHE_PATH
+     */
+    static std::string getCachePath(const std::string& modelPath, const ModelData& data);
+
+    /**
+     * @brief Hashes the whole content of a file
+     * 
+     * @param path Path to the file
+     * @param hash Set to the hash of the file on success
+     * @return True if the file could be read
+     */
+    static bool hashFile(const std::string& path, uint64_t& hash);
+
+    /**
+     * @brief Checks a file still matches the size, modification time and hash recorded in a cache
+     * 
+     * The content is only hashed when the size matches but the modification time changed.
+     * 
+     * @param path Path to the file
+     * @param size Recorded size in bytes
+     * @param modifiedTime Recorded last write time
+     * @param hash Recorded content hash
+     * @return True if the file is unchanged
+     */
+    static bool isUnchanged(const std::string& path, uint64_t size, int64_t modifiedTime, uint64_t hash);
+
+    /**
+     * @brief Finds the material library referenced by an OBJ file
+     * 
+     * @param modelPath Path to the model file
+     * @return The library path as written after `mtllib`, empty if there is none or the model is not an OBJ
+     */
+    static std::string findMaterialLibrary(const std::string& modelPath);
+
+public:
+    /**
+     * @brief Reads the cached geometry of a model
+     * 
+     * @param modelPath Path to the model file
+     * @param data The model data to fill, its profile and optimizer setting select the cache entry
+     * @return True if a valid cache entry was read, false if the model must be imported
+     */
+    static bool read(const std::string& modelPath, ModelData& data);
+
+    /**
+     * @brief Writes the geometry of an imported model to the cache
+     * 
+     * @param modelPath Path to the model file the data was imported from
+     * @param data The imported model data
+     * @return True if the cache file was written
+     */
+    static bool write(const std::string& modelPath, const ModelData& data);
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <vector>
+#include <GL/glew.h>
+
+#include "rendering/mesh.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @class MeshOptimizer
+ * @brief Reorders mesh data for the GPU's post-transform cache, overdraw and vertex fetch
+ *
+ * Runs on CPU-side mesh data after import and before upload. The geometry itself is left
+ * untouched, only the order of triangles and vertices changes:
+ * 1. Triangles are reordered for vertex cache reuse (Forsyth's linear-speed algorithm).
+ * 2. Triangle clusters are sorted so outward facing ones are drawn first, reducing overdraw
+ *    from any viewpoint without undoing most of the cache gains.
+ * 3. Vertices are reordered by first use so fetches walk the vertex buffer linearly.
+ */
+class MeshOptimizer {
+private:
+    /**
+     * @brief Scores a vertex for Forsyth's algorithm
+     *
+     * @param cachePosition Position of the vertex in the simulated cache, -1 if not cached
+     * @param liveTriangles Number of triangles using the vertex that are not emitted yet
+     * @return The vertex score, higher means its triangles should be emitted sooner
+     */
+    static float vertexScore(int cachePosition, unsigned int liveTriangles);
+
+    /**
+     * @brief Splits an index buffer into clusters for overdraw sorting
+     *
+     * Clusters start where the cache simulation sees a disjoint patch, and are split further
+     * wherever the running ACMR drops below the cluster's ACMR scaled by the threshold.
+     *
+     * @param indices The cache optimized triangle list
+     * @param vertexCount Number of vertices referenced by the indices
+     * @param threshold Allowed ACMR degradation, 1.05 allows 5% worse cache efficiency
+     * @return The first triangle of every cluster, in order
+     */
+    static std::vector<size_t> buildClusters(const std::vector<GLuint>& indices, size_t vertexCount, float threshold);
+
+public:
+    /**
+     * @brief Runs every optimization pass on a mesh
+     *
+     * @param mesh The mesh data reordered in place
+     */
+    static void optimize(MeshData& mesh);
+
+    /**
+     * @brief Reorders triangles to maximize post-transform vertex cache hits
+     *
+     * @param indices The triangle list reordered in place
+     * @param vertexCount Number of vertices referenced by the indices
+     */
+    static void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount);
+
+    /**
+     * @brief Reorders triangle clusters so outward facing ones are drawn first
+     *
+     * Expects a cache optimized index buffer, the order within each cluster is kept.
+     *
+     * @param indices The triangle list reordered in place
+     * @param vertices The vertices referenced by the indices
+     * @param threshold Allowed ACMR degradation, 1.05 allows 5% worse cache efficiency
+     */
+    static void optimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold = OVERDRAW_THRESHOLD);
+
+    /**
+     * @brief Reorders vertices by first use and drops unreferenced ones
+     *
+     * @param vertices The vertex buffer reordered in place
+     * @param indices The triangle list remapped in place
+     */
+    static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices);
+
+    /**
+     * @brief Counts the vertices a FIFO post-transform cache would transform
+     *
+     * Dividing by the triangle count gives the ACMR (average cache miss ratio, 0.5 is ideal
+     * for regular grids, 3 is worst), dividing by the vertex count gives the ATVR (average
+     * transform to vertex ratio, 1 is ideal).
+     *
+     * @param indices The triangle list
+     * @param vertexCount Number of vertices referenced by the indices
+     * @param cacheSize Number of entries of the simulated cache
+     * @return The number of cache misses
+     */
+    static size_t simulateVertexCache(const std::vector<GLuint>& indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+    /**
+     * @brief Splits a mesh into parts that each reference at most a given number of vertices
+     *
+     * Triangles are assigned to parts in index order, so a cache optimized mesh is cut into
+     * spatially coherent parts. Vertices shared by two parts are duplicated. Every part keeps
+     * the textures and shininess of the mesh and gets its own bounds.
+     *
+     * @param mesh The mesh to split
+     * @param maxVertices Maximum number of vertices of a part, at least 3
+     * @return The parts, a single copy of the mesh if it already fits
+     */
+    static std::vector<MeshData> splitMesh(const MeshData& mesh, size_t maxVertices = MAX_SHORT_INDEX_VERTICES);
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+#include "rendering/mesh.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @class MeshSimplifier
+ * @brief Reduces the triangle count of a mesh with quadric error metrics
+ *
+ * Simplification works on the index buffer only: every edge collapse moves a vertex onto one of
+ * its neighbours, so the simplified triangles reference a subset of the original vertices and a
+ * whole LOD chain can share a single vertex buffer.
+ *
+ * Vertices sharing a position but not their attributes (UV or normal seams) are locked, as are
+ * vertices on non-manifold edges. Vertices on open borders only slide along the border, so
+ * neither holes nor texture seams open up.
+ */
+class MeshSimplifier {
+private:
+    /**
+     * @struct Quadric
+     * @brief Sum of weighted squared distances to a set of planes
+     */
+    struct Quadric {
+        double a00 = 0.0, a11 = 0.0, a22 = 0.0;    ///< Diagonal of the quadratic term
+        double a01 = 0.0, a02 = 0.0, a12 = 0.0;    ///< Off-diagonal of the quadratic term
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;       ///< Linear term
+        double c = 0.0;                             ///< Constant term
+        double weight = 0.0;                        ///< Sum of the plane weights
+
+        /**
+         * @brief Adds a plane to the quadric
+         *
+         * @param normal Unit normal of the plane
+         * @param distance Plane offset, the plane being dot(normal, p) + distance = 0
+         * @param planeWeight Weight of the plane, usually the area it stands for
+         */
+        void addPlane(const glm::vec3& normal, float distance, float planeWeight);
+
+        /**
+         * @brief Adds every plane of another quadric
+         *
+         * @param other The quadric to merge
+         */
+        void add(const Quadric& other);
+
+        /**
+         * @brief Evaluates the error of moving the vertex to a position
+         *
+         * @param position The candidate position
+         * @return The weighted root mean square distance to the planes
+         */
+        float error(const glm::vec3& position) const;
+    };
+
+    /**
+     * @struct Collapse
+     * @brief A candidate edge collapse
+     */
+    struct Collapse {
+        GLuint from;    ///< Vertex removed by the collapse
+        GLuint to;      ///< Vertex it is merged into
+        float error;    ///< Error introduced by the collapse
+    };
+
+    /**
+     * @brief Maps every vertex to the first vertex with the same leading bytes
+     *
+     * @param vertices The vertices
+     * @param bytes Number of leading bytes of each Vertex compared, sizeof(glm::vec3) compares positions
+     * @return The representative vertex of each vertex
+     */
+    static std::vector<GLuint> buildRemap(const std::vector<Vertex>& vertices, size_t bytes);
+
+    /**
+     * @brief Lists the undirected position edges of the triangles along with their use count
+     *
+     * @param indices The triangle list
+     * @param position Position representative of each vertex
+     * @return Sorted edge keys, one per triangle edge, so equal keys are adjacent
+     */
+    static std::vector<uint64_t> collectEdges(const std::vector<GLuint>& indices, const std::vector<GLuint>& position);
+
+    /**
+     * @brief Checks whether a collapse would flip any triangle around the removed vertex
+     *
+     * @param vertices The vertices
+     * @param indices The triangle list
+     * @param offsets Start of each vertex's triangles within adjacency
+     * @param adjacency Triangles using each vertex, grouped by vertex
+     * @param position Position representative of each vertex
+     * @param remap Collapses already done in the current pass
+     * @param from Vertex removed by the collapse
+     * @param to Vertex it is merged into
+     * @return True if a remaining triangle would face the other way
+     */
+    static bool hasTriangleFlips(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                 const std::vector<size_t>& offsets, const std::vector<size_t>& adjacency,
+                                 const std::vector<GLuint>& position, const std::vector<GLuint>& remap, GLuint from, GLuint to);
+
+public:
+    /**
+     * @brief Simplifies a triangle list towards a target index count
+     *
+     * Collapses are done in passes, cheapest first, until the target is reached, no collapse is
+     * left or the next collapse would exceed the error limit.
+     *
+     * @param vertices The vertices referenced by the indices
+     * @param indices The triangle list to simplify
+     * @param targetIndexCount Number of indices to reach
+     * @param maxError Largest error allowed for a collapse, in model units
+     * @param resultError Set to the largest error of the collapses done, in model units
+     * @return The simplified triangle list, referencing the same vertices
+     */
+    static std::vector<GLuint> simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                        size_t targetIndexCount, float maxError, float& resultError);
+};
@@ -1,13 +1,23 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <cfloat>
 #include <assimp/scene.h>
 
 #include "rendering/mesh.hpp"
 #include "object.hpp"
 #include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <limits>
 #include <assimp/Importer.hpp>
+#include "rendering/textureLoader.hpp"
+#include "rendering/modelSettings.hpp"
+#include "rendering/vertexPacking.hpp"
+#include "rendering/bvh.hpp"
+#include "rendering/renderQueue.hpp"
 
 /*
 Obj file info:
@@ -34,6 +44,86 @@ map_Ks specular.png   # Specular texture (Shininess Map)
 map_Bump normal.png   # Normal map (bump mapping), encodes surface bumps
 */
 
+/**
+ * @struct ModelStats
+ * @brief Geometry counts of a model
+ * 
+ * Used to compare a model before and after the optimization passes of its import profile.
+ */
+struct ModelStats {
+    size_t meshCount = 0;                   ///< Number of meshes
+    size_t vertexCount = 0;                 ///< Number of vertices over all meshes
+    size_t indexCount = 0;                  ///< Number of indices over all meshes
+    size_t transformedVertices = 0;         ///< Vertices transformed by a simulated FIFO post-transform cache
+    size_t vertexSize = sizeof(Vertex);     ///< Size of one vertex in the vertex buffer, in bytes
+    size_t shortIndexMeshes = 0;            ///< Number of meshes drawn with 16-bit indices
+    size_t shortIndexCount = 0;             ///< Number of indices stored as 16-bit values
+    size_t lodCount = 0;                    ///< Number of simplified levels of detail over all meshes
+    size_t lodIndexCount = 0;               ///< Number of indices of the simplified levels
+    size_t lodIndexBytes = 0;               ///< Size of the simplified levels' indices on the GPU
+
+    /**
+     * @brief Gets the average cache miss ratio, vertices transformed per triangle
+     * 
+     * @return The ACMR, between 0.5 (ideal) and 3 (no reuse)
+     */
+    float getAcmr() const { return indexCount ? float(transformedVertices) / float(indexCount / 3) : 0.0f; }
+
+    /**
+     * @brief Gets the average transform to vertex ratio, transforms per unique vertex
+     * 
+     * @return The ATVR, 1 being ideal
+     */
+    float getAtvr() const { return vertexCount ? float(transformedVertices) / float(vertexCount) : 0.0f; }
+
+    /**
+     * @brief Gets the size of the full resolution index buffers on the GPU
+     * 
+     * @return The index buffer size in bytes, levels of detail excluded
+     */
+    size_t getFullIndexBytes() const { return (indexCount - shortIndexCount) * sizeof(GLuint) + shortIndexCount * sizeof(GLushort); }
+
+    /**
+     * @brief Gets the size of the index buffers on the GPU
+     * 
+     * @return The index buffer size in bytes, levels of detail included
+     */
+    size_t getIndexBytes() const { return getFullIndexBytes() + lodIndexBytes; }
+
+    /**
+     * @brief Gets the index fetch bandwidth saved per frame by 16-bit indices when drawing at full resolution
+     * 
+     * @return The saving in bytes compared to 32-bit indices everywhere
+     */
+    size_t getIndexBytesSaved() const { return indexCount * sizeof(GLuint) - getFullIndexBytes(); }
+
+    /**
+     * @brief Gets the size of the vertex and index buffers on the GPU
+     * 
+     * @return The buffer size in bytes
+     */
+    size_t getBufferBytes() const { return vertexCount * vertexSize + getIndexBytes(); }
+};
+
+/**
+ * @struct ModelData
+ * @brief CPU-side result of loading a model file
+ * 
+ * Contains the geometry and material bindings of every mesh along with the model bounds
+ * and the resolved UV flip decision. This is what the mesh cache stores on disk.
+ */
+struct ModelData {
+    std::vector<MeshData> meshes;           ///< The meshes that make up the model
+    glm::vec3 minBounds = glm::vec3(FLT_MAX);  ///< The minimum bounds (corner) of the model
+    glm::vec3 maxBounds = glm::vec3(-FLT_MAX); ///< The maximum bounds (corner) of the model
+    bool needFlip = false;                  ///< Whether the UVs were flipped on import
+    ImportProfile profile = DEFAULT_IMPORT_PROFILE; ///< Import profile the geometry was processed with
+    ModelStats sourceStats;                 ///< Geometry counts before the profile's optimization passes
+    bool meshOptimized = false;             ///< Whether the MeshOptimizer passes were run after import
+    bool indicesSplit = false;              ///< Whether meshes slightly over the 16-bit limit were split
+    bool lodsGenerated = false;             ///< Whether the simplified levels of detail were generated
+};
+
 /**
  * @class Model
  * @brief Represents a 3D model loaded from an OBJ file
@@ -44,11 +134,9 @@ map_Bump normal.png   # Normal map (bump mapping), encodes surface bumps
  */
 class Model : public Object {
 private:
-    Assimp::Importer import;                ///< Assimp importer for model loading with texture flipping
-    Assimp::Importer importWithoutFlip;      ///< Assimp importer for model loading without texture flipping
-    const aiScene* scene;                   ///< Assimp scene object containing the loaded model data
-
     bool needFlip = false;                  ///< Flag indicating whether model textures need to be flipped
+    std::vector<size_t> uvMeshes;           ///< Indices of the processed meshes that have texture coordinates
+    size_t flipVotes = 0;                   ///< Number of processed meshes whose UVs require flipping
     glm::vec3 modelSize;                    ///< The size of the model (width, height, depth)
     glm::vec3 modelCenter;                  ///< The center of the model's bounding box
     float modelRadius;                      ///< The radius of the model's bounding sphere
@@ -56,93 +144,210 @@ private:
     glm::vec3 minBounds;                    ///< The minimum bounds (corner) of the model
     glm::vec3 maxBounds;                    ///< The maximum bounds (corner) of the model
 
-    std::vector<Texture> textures_loaded;    ///< A list of textures that have been loaded
+    std::unordered_map<std::string, GLuint> textures_loaded; ///< Texture handles acquired from the texture cache, by path
+    GLuint nullTexture = 0;                  ///< Shared white texture acquired for meshes without textures, 0 if unused
     std::vector<std::unique_ptr<Mesh>> meshes; ///< A list of meshes that make up the model
     std::string directory;                   ///< Directory path of the model for texture loading
 
+    bool loadedFromCache = false;            ///< Whether the geometry came from the mesh cache instead of Assimp
+    ModelSettings settings;                  ///< Import and residency settings the model was loaded with
+    ModelStats sourceStats;                  ///< Geometry counts before the profile's optimization passes
+    ModelStats stats;                        ///< Geometry counts after the profile's optimization passes
+    PackingError packingError;               ///< Largest decode error of the packed vertices, zero if not packed
+    float lodPixelError = LOD_PIXEL_ERROR;   ///< Largest simplification error allowed on screen, in pixels
+    size_t drawnTriangles = 0;               ///< Triangles submitted by the last draw
+    std::vector<char> meshVisible;           ///< Visibility of each mesh from the last culling pass
+    bool frustumCulling = true;              ///< Whether meshes outside the view or too small are skipped
+    size_t drawnMeshes = 0;                  ///< Meshes drawn by the last draw
+    size_t culledMeshes = 0;                 ///< Meshes skipped by the last culling pass
+    Bvh bvh;                                 ///< Hierarchy over the full resolution triangles, for ray casts, empty with lean residency
+    double bvhBuildTime = 0.0;               ///< Time taken to build the hierarchy, in milliseconds
+    std::vector<glm::mat4> instances;        ///< World transforms applied after the model matrix, one per instance, empty if not instanced
+    GlBuffer instanceBuffer;                 ///< GPU copy of the instance transforms, empty until instances are set
+    std::vector<glm::mat4> instanceWorlds;   ///< Full world transform of each instance, reused by every culling pass
+    std::vector<float> instanceScales;       ///< Bounding sphere scale of each instance, reused by every culling pass
+    bool instancedDrawing = true;            ///< Whether all instances of a mesh are drawn in one call
+    size_t drawCalls = 0;                    ///< Draw calls issued by the last draw
+    double loadTime = 0.0;                   ///< Time taken to load the model, in milliseconds
+    std::string modelPath;                   ///< Path of the loaded model file
+
+    ModelData pendingData;                   ///< Loaded geometry waiting to be uploaded to the GPU
+    std::vector<std::string> pendingTexturePaths; ///< Paths of the decoded textures waiting for upload, resident ones are acquired instead
+    std::vector<DecodedImage> pendingImages; ///< Decoded textures waiting for upload
+    size_t uploadedTextures = 0;             ///< Number of pending textures already uploaded
+    size_t uploadedMeshes = 0;               ///< Number of pending meshes already uploaded
+    bool uploaded = false;                   ///< Whether all GPU resources of the model are ready
+    std::atomic<float>* progress = nullptr;  ///< Load progress reported to the UI, may be null
+
     /**
      * @brief Loads a 3D model from a file
      * 
-     * This function uses the Assimp library to load the model and its associated meshes and textures.
-     * The function also checks whether texture flipping is required based on the model's UV mapping.
+     * The geometry is read from the mesh cache when a valid entry exists for the file. Otherwise the
+     * file is imported through Assimp and the result is written to the cache for the next load.
+     * The textures are then decoded. Nothing is uploaded to the GPU, so this is safe to run on a
+     * worker thread.
      * 
      * @param path The path to the model file
      */
     void loadModel(const std::string &path);
 
+    /**
+     * @brief Imports a 3D model file through Assimp
+     * 
+     * This function uses the Assimp library to load the model's meshes and material bindings.
+     * The function also checks whether texture flipping is required based on the model's UV mapping.
+     * The geometry is counted after triangulation, then the optimization passes of the model's import
+     * profile are applied. The Assimp scene only lives for the duration of the call.
+     * 
+     * @param path The path to the model file
+     * @param data The model data to fill
+     * @return True if the import succeeded, false otherwise
+     */
+    bool importModel(const std::string &path, ModelData& data);
+
+    /**
+     * @brief Runs the MeshOptimizer passes on every mesh of the model data
+     * 
+     * Meshes are optimized concurrently on worker threads.
+     * 
+     * @param data The imported model data, reordered in place
+     */
+    void optimizeMeshes(ModelData& data);
+
+    /**
+     * @brief Splits the meshes slightly too large for 16-bit indices
+     * 
+     * Only meshes needing at most INDEX_SPLIT_MAX_PARTS parts are split, larger meshes keep
+     * 32-bit indices rather than adding many draw calls.
+     * 
+     * @param data The model data whose meshes are split in place
+     */
+    void splitMeshes(ModelData& data);
+
+    /**
+     * @brief Builds the simplified levels of detail of every mesh of the model data
+     * 
+     * Each level targets LOD_REDUCTION_RATIO of the previous level's triangles. The chain stops
+     * early once a level barely reduces the mesh, the error limit is reached or the mesh is small.
+     * Meshes are simplified concurrently on worker threads.
+     * 
+     * @param data The model data whose LOD chains are filled
+     */
+    void generateLods(ModelData& data);
+
+    /**
+     * @brief Packs the vertices of every mesh of the model data into the compact layout
+     * 
+     * Meshes are packed concurrently on worker threads, and the packed vertices are decoded back
+     * to measure the error against the float vertices.
+     * 
+     * @param data The model data whose packed vertices are filled
+     */
+    void packVertices(ModelData& data);
+
+    /**
+     * @brief Sets the load progress reported to the UI, if any
+     * 
+     * @param value Progress between 0 and 1
+     */
+    void setProgress(float value);
+
+    /**
+     * @brief Sets the load progress from the share of pending resources already uploaded
+     */
+    void setUploadProgress();
+
     /**
      * @brief Determines whether the model requires flipping of texture coordinates
      * 
-     * The function checks if more than half of the model's meshes require flipping of their UVs.
+     * The function checks if more than half of the processed meshes with UVs voted for flipping.
      * 
-     * @param scene The Assimp scene object
      * @return True if the model requires texture flipping, false otherwise
      */
-    bool shouldFlipModel(const aiScene* scene);
+    bool shouldFlipModel() const;
 
     /**
-     * @brief Checks if the given mesh requires flipping of texture coordinates
+     * @brief Checks if a mesh requires flipping of texture coordinates from its V range
      * 
-     * This function evaluates whether a mesh has UV coordinates that span the full height (from 0 to 1),
-     * which indicates that it requires flipping.
+     * A V range spanning the full height (from 0 to 1) indicates that the mesh requires flipping.
      * 
-     * @param mesh The mesh to evaluate
+     * @param minV The smallest V coordinate of the mesh
+     * @param maxV The largest V coordinate of the mesh
      * @return True if the mesh requires texture flipping, false otherwise
      */
-    bool meshRequireFlip(const aiMesh* mesh);
+    static bool meshRequireFlip(float minV, float maxV);
+
+    /**
+     * @brief Flips the V coordinate of every mesh that has texture coordinates
+     * 
+     * @param data The model data whose UVs are flipped in place
+     */
+    void flipTextureCoords(ModelData& data);
 
     /**
      * @brief Processes the nodes in the Assimp scene hierarchy
      * 
      * The function recursively processes all nodes in the scene. For each node, it processes the meshes 
-     * associated with that node and adds them to the model.
+     * associated with that node and adds them to the model data.
      * 
      * @param node The Assimp node to process
      * @param scene The Assimp scene object
+     * @param data The model data to fill
      */
-    void processNode(aiNode *node, const aiScene *scene);
+    void processNode(aiNode *node, const aiScene *scene, ModelData& data);
 
     /**
-     * @brief Processes a single mesh and converts it into a Mesh object
+     * @brief Processes a single mesh and converts it into mesh data
      * 
      * The function processes the mesh by extracting vertex positions, normals, texture coordinates, 
-     * and indices. It also handles applying materials and textures to the mesh.
+     * and indices. It also collects the textures referenced by the mesh's material.
      * 
      * @param mesh The Assimp mesh to process
      * @param scene The Assimp scene object
-     * @return A unique pointer to the processed Mesh object
+     * @param data The model data whose bounds are updated
+     * @return The processed mesh data
      */
-    std::unique_ptr<Mesh> processMesh(aiMesh *mesh, const aiScene *scene);
+    MeshData processMesh(aiMesh *mesh, const aiScene *scene, ModelData& data);
 
     /**
-     * @brief Loads the textures associated with a material
+     * @brief Reads the textures referenced by a material
      * 
-     * This function loads textures of a given type from the material of a mesh. It avoids reloading 
-     * duplicate textures by checking a list of already loaded textures.
+     * This function collects the paths of the textures of a given type from the material of a mesh.
+     * No image is loaded at this stage.
      * 
      * @param mat The Assimp material object
-     * @param type The type of texture to load (e.g., diffuse, specular)
+     * @param type The type of texture to read (e.g., diffuse, specular)
      * @param typeName The name of the texture type (e.g., "texture_diffuse")
-     * @return A vector of loaded Texture objects
+     * @return A vector of Texture objects with unresolved IDs
+     */
+    std::vector<Texture> readMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
+
+    /**
+     * @brief Loads the textures of a mesh
+     * 
+     * This function resolves the OpenGL ID of every texture of a mesh from the textures acquired by
+     * the model. Textures that could not be decoded use the shared null texture, so nothing is
+     * read from disk on the GL thread.
+     * 
+     * @param textures The textures to load, their IDs are set in place
      */
-    std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
+    void loadMaterialTextures(std::vector<Texture>& textures);
 
     /**
-     * @brief Creates a texture from a file
+     * @brief Decodes every texture of the model data that is not loaded yet
      * 
-     * This function loads a texture image from disk and generates an OpenGL texture ID. It supports 
-     * various texture formats and generates mipmaps for efficient rendering.
+     * Textures already resident in the shared texture cache are acquired right away, so they cannot
+     * be evicted before the upload. The others are decoded concurrently on worker threads and kept
+     * in CPU memory until upload() sends them to the GPU in one batch.
      * 
-     * @param path The path to the texture file
-     * @param directory The directory where the texture is located
-     * @return The generated OpenGL texture ID
+     * @param data The model data whose textures are decoded
      */
-    unsigned int textureFromFile(const std::string &path, const std::string &directory);
+    void decodeTextures(const ModelData& data);
 
     /**
      * @brief Applies a default white texture when no texture is found
      * 
-     * This function generates a simple 1x1 white texture and returns its OpenGL texture ID.
+     * The simple 1x1 white texture is shared through the texture cache and acquired once per model.
      * 
      * @return The OpenGL texture ID for the default white texture
      */
@@ -153,11 +358,50 @@ public:
      * @brief Constructs a new Model object from a file
      * 
      * The constructor loads a 3D model from a file, processes the meshes, and calculates the model's 
-     * dimensions (size, center, radius).
+     * dimensions (size, center, radius). The GPU resources are uploaded before returning.
      * 
      * @param path The path to the model file
+     * @param settings The import and residency settings
+     */
+    Model(const std::string &path, const ModelSettings& settings = ModelSettings());
+
+    /**
+     * @brief Loads a new Model object from a file without touching the GPU
+     * 
+     * Performs all disk and decode work so it can run on a worker thread. upload() must then
+     * be called on the GL thread before the model is drawn.
+     * 
+     * @param path The path to the model file
+     * @param settings The import and residency settings
+     * @param progress Load progress between 0 and 1 updated while loading and uploading, may be null
+     */
+    Model(const std::string &path, const ModelSettings& settings, std::atomic<float>* progress);
+
+    /**
+     * @brief Gets the Assimp post-processing flags of an import profile
+     * 
+     * @param profile The import profile
+     * @return The flags passed to Assimp
      */
-    Model(const std::string &path);
+    static unsigned int getImportFlags(ImportProfile profile);
+
+    /**
+     * @brief Uploads the loaded textures and meshes to the GPU
+     * 
+     * Must be called from the thread owning the GL context. Work stops once the time budget is
+     * spent, so the upload can be spread across several frames by calling this again.
+     * 
+     * @param budget Maximum time to spend, in milliseconds
+     * @return True once all GPU resources of the model are ready
+     */
+    bool upload(double budget = std::numeric_limits<double>::infinity());
+
+    /**
+     * @brief Checks whether all GPU resources of the model are ready
+     * 
+     * @return True if the model can be drawn
+     */
+    bool isUploaded() const { return uploaded; }
 
     /**
      * @brief Destructor to clean up resources
@@ -181,13 +425,65 @@ public:
     void calculateModelDimension();
 
     /**
-     * @brief Draws the model using a given shader program
+     * @brief Queues the visible meshes of the model for drawing
      * 
-     * This function iterates through all meshes in the model and renders them using the provided shader program.
+     * This function iterates through all meshes in the model and submits the visible ones with the provided
+     * shader program. Nothing is drawn until the queue is executed.
      * 
-     * @param shader The shader program to use for rendering
+     * @param shader The shader program to use for rendering, its frame uniforms already set
+     * @param queue The render queue of the frame
+     * @param view The view matrix, orders the meshes front-to-back
      */
-    void draw(ShaderProgram &shader);
+    void draw(ShaderProgram &shader, RenderQueue& queue, const glm::mat4& view);
+
+    /**
+     * @brief Selects the level of detail of every mesh from the projected size of the model
+     * 
+     * The model's bounding sphere gives the distance to the camera, from which the screen size of
+     * one model unit follows. Must be called before draw() whenever the camera or model moved.
+     * 
+     * @param cameraPos The camera position in world space
+     * @param projection The projection matrix
+     * @param viewportHeight The height of the viewport, in pixels
+     */
+    void selectLods(const glm::vec3& cameraPos, const glm::mat4& projection, float viewportHeight);
+
+    /**
+     * @brief Decides which meshes the next draw() skips
+     * 
+     * A mesh is culled when its bounding sphere or box is outside the view frustum, or when its
+     * bounding sphere projects to less than CULL_MIN_PIXEL_RADIUS pixels.
+     * 
+     * @param cameraPos The camera position in world space
+     * @param view The view matrix
+     * @param projection The projection matrix
+     * @param viewportHeight The height of the viewport, in pixels
+     */
+    void cullMeshes(const glm::vec3& cameraPos, const glm::mat4& view, const glm::mat4& projection, float viewportHeight);
+
+    /**
+     * @brief Sets the transforms of the instances drawn in place of the single model
+     * 
+     * Each transform is applied after the model matrix and may only rotate, translate and scale
+     * uniformly. The transforms are copied to an instance buffer shared by every mesh, so the
+     * model must be uploaded and this must be called from the GL thread.
+     * 
+     * @param transforms One world transform per instance, empty to draw the model once
+     */
+    void setInstances(const std::vector<glm::mat4>& transforms);
+
+    /**
+     * @brief Finds the closest triangle of the model hit by a ray
+     * 
+     * The ray is brought into model space so the hierarchy never needs rebuilding when the model
+     * moves, once per instance when instanced. Always tests the full resolution triangles, whatever
+     * level of detail is drawn. Never hits with lean residency, as no hierarchy is built.
+     * 
+     * @param origin Origin of the ray, in world space
+     * @param direction Direction of the ray, in world space
+     * @return The closest hit, with its world space position and distance from the origin
+     */
+    RayHit raycast(const glm::vec3& origin, const glm::vec3& direction) const;
 
     /**
      * @brief Gets the center of the model's bounding box
@@ -202,4 +498,158 @@ public:
      * @return The model's radius
      */
     const float getModelRadius() const;
+
+    /**
+     * @brief Checks whether the model was loaded from the mesh cache
+     * 
+     * @return True if Assimp was bypassed, false if the file was imported
+     */
+    bool isLoadedFromCache() const { return loadedFromCache; }
+
+    /**
+     * @brief Gets the time it took to load the model
+     * 
+     * @return The load time in milliseconds
+     */
+    double getLoadTime() const { return loadTime; }
+
+    /**
+     * @brief Gets the import profile the model was loaded with
+     * 
+     * @return The Assimp post-processing profile
+     */
+    ImportProfile getImportProfile() const { return settings.importProfile; }
+
+    /**
+     * @brief Checks whether the model frees its CPU geometry once uploaded
+     * 
+     * @return True if meshes only keep their GPU buffers
+     */
+    bool isLeanResidency() const { return settings.leanResidency; }
+
+    /**
+     * @brief Gets the settings the model was loaded with
+     * 
+     * @return The import and residency settings
+     */
+    const ModelSettings& getSettings() const { return settings; }
+
+    /**
+     * @brief Gets the geometry counts before the import profile's optimization passes
+     * 
+     * @return The triangulated source geometry counts
+     */
+    const ModelStats& getSourceStats() const { return sourceStats; }
+
+    /**
+     * @brief Gets the geometry counts of the model as uploaded
+     * 
+     * @return The optimized geometry counts
+     */
+    const ModelStats& getStats() const { return stats; }
+
+    /**
+     * @brief Gets the largest decode error of the packed vertices
+     * 
+     * @return The packing error, zero if the model uses float vertices
+     */
+    const PackingError& getPackingError() const { return packingError; }
+
+    /**
+     * @brief Sets the largest simplification error allowed on screen
+     * 
+     * @param newPixelError The error in pixels, 0 always draws the full resolution meshes
+     */
+    void setLodPixelError(float newPixelError) { lodPixelError = newPixelError; }
+
+    /**
+     * @brief Gets the largest simplification error allowed on screen
+     * 
+     * @return The error in pixels
+     */
+    float getLodPixelError() const { return lodPixelError; }
+
+    /**
+     * @brief Gets the number of triangles submitted by the last draw
+     * 
+     * @return The triangle count at the selected levels of detail
+     */
+    size_t getDrawnTriangles() const { return drawnTriangles; }
+
+    /**
+     * @brief Gets the number of triangles of the model at full resolution
+     * 
+     * @return The triangle count of every mesh's level 0
+     */
+    size_t getTriangleCount() const { return stats.indexCount / 3; }
+
+    /**
+     * @brief Enables or disables frustum and screen size culling
+     * 
+     * @param enabled True to skip meshes that are not visible
+     */
+    void setFrustumCulling(bool enabled) { frustumCulling = enabled; }
+
+    /**
+     * @brief Checks whether frustum and screen size culling is enabled
+     * 
+     * @return True if meshes that are not visible are skipped
+     */
+    bool isFrustumCulling() const { return frustumCulling; }
+
+    /**
+     * @brief Gets the number of meshes drawn by the last draw
+     * 
+     * @return The drawn mesh count
+     */
+    size_t getDrawnMeshes() const { return drawnMeshes; }
+
+    /**
+     * @brief Gets the number of meshes skipped by the last culling pass
+     * 
+     * @return The culled mesh count
+     */
+    size_t getCulledMeshes() const { return culledMeshes; }
+
+    /**
+     * @brief Gets the ray casting hierarchy of the model
+     * 
+     * @return The hierarchy over the full resolution triangles, empty with lean residency
+     */
+    const Bvh& getBvh() const { return bvh; }
+
+    /**
+     * @brief Gets the time it took to build the ray casting hierarchy
+     * 
+     * @return The build time in milliseconds
+     */
+    double getBvhBuildTime() const { return bvhBuildTime; }
+
+    /**
+     * @brief Gets the number of copies of the model drawn
+     * 
+     * @return The instance count, 1 if not instanced
+     */
+    size_t getInstanceCount() const { return std::max<size_t>(instances.size(), 1); }
+
+    /**
+     * @brief Chooses between one draw call per mesh and one per mesh and instance
+     * 
+     * @param enabled True to draw all instances of a mesh in a single call
+     */
+    void setInstancedDrawing(bool enabled) { instancedDrawing = enabled; }
+
+    /**
+     * @brief Checks whether all instances of a mesh are drawn in one call
+     * 
+     * @return True if instanced draw calls are used
+     */
+    bool isInstancedDrawing() const { return instancedDrawing; }
+
+    /**
+     * @brief Gets the number of draw calls issued by the last draw
+     * 
+     * @return The draw call count
+     */
+    size_t getDrawCalls() const { return drawCalls; }
 };
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "utils/constants.hpp"
+
+/**
+ * @struct ModelSettings
+ * @brief Options controlling how a model is imported and kept in memory
+ * 
+ * Two models loaded from the same file with equal settings are identical, so a change
+ * of settings requires the model to be reloaded.
+ */
+struct ModelSettings {
+    ImportProfile importProfile = DEFAULT_IMPORT_PROFILE; ///< Assimp post-processing profile used for the import
+    bool leanResidency = false;     ///< Free CPU copies of the geometry once uploaded to the GPU
+    bool meshOptimization = true;   ///< Reorder triangles and vertices for the GPU caches after import
+    bool packedVertices = false;    ///< Upload vertices in the compact 16 byte layout instead of 32 byte floats
+    bool splitIndexBuffers = false; ///< Split meshes slightly over 65536 vertices so they fit 16-bit indices
+    bool generateLods = true;       ///< Build simplified levels of detail drawn when the model is small on screen
+
+    bool operator==(const ModelSettings& other) const = default;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "rendering/gpuTimer.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @struct GpuPassTimes
+ * @brief GPU time spent in each render pass of a frame, in milliseconds
+ */
+struct GpuPassTimes {
+    float milliseconds[(int) RenderPass::COUNT] = {};  ///< Time of each pass, 0 for passes not drawn
+
+    /**
+     * @brief Sums the time of every pass
+     *
+     * @return Time in milliseconds
+     */
+    float getTotal() const {
+        float total = 0.0f;
+        for (float time : milliseconds) total += time;
+        return total;
+    }
+};
+
+/**
+ * @class PassTimers
+ * @brief Times every render pass of the main loop with its own GPU timer
+ *
+ * Each pass records into a ring of PASS_TIMER_QUERIES queries whose results are read back
+ * frames later, once available. When the GPU falls so far behind that every query of a pass is
+ * still pending, the pass is not timed that frame and keeps its last time, so the frame loop
+ * never waits on a query. Passes are timed one after the other, never nested, as OpenGL allows
+ * a single active GL_TIME_ELAPSED query.
+ */
+class PassTimers {
+private:
+    std::vector<std::unique_ptr<GpuTimer>> timers;  ///< One timer per pass
+    bool drawn[(int) RenderPass::COUNT] = {};       ///< Passes drawn since the last endFrame()
+    bool running[(int) RenderPass::COUNT] = {};     ///< Passes whose query is active
+    GpuPassTimes times;                             ///< Most recent times read back
+
+public:
+    /**
+     * @brief Creates the query rings of every pass
+     */
+    PassTimers();
+
+    /**
+     * @brief Starts timing a pass, unless all its queries are still pending
+     *
+     * @param pass The pass whose commands follow
+     */
+    void begin(RenderPass pass);
+
+    /**
+     * @brief Stops timing a pass
+     *
+     * @param pass The pass started by the last begin()
+     */
+    void end(RenderPass pass);
+
+    /**
+     * @brief Reads back the times that became available, without waiting
+     *
+     * Call once per frame, after every pass is drawn. Passes not drawn this frame report 0.
+     */
+    void endFrame();
+
+    /**
+     * @brief Gets the most recent time of each pass
+     *
+     * @return The pass times
+     */
+    const GpuPassTimes& getTimes() const { return times; }
+};
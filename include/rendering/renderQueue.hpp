@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <GL/glew.h>
+
+#include "rendering/mesh.hpp"
+#include "shader/shaderProgram.hpp"
+
+/**
+ * @struct RenderQueueStats
+ * @brief State changes of the last executed frame
+ *
+ * A state change is a program, VAO or texture bind, or a uniform upload.
+ */
+struct RenderQueueStats {
+    size_t packets = 0;             ///< Draw packets executed
+    size_t naiveStateChanges = 0;   ///< State changes if every packet had set its full state, as drawing each mesh directly does
+    size_t stateChanges = 0;        ///< State changes actually issued
+};
+
+/**
+ * @class RenderQueue
+ * @brief Collects the draws of a frame, sorts them and executes them with as few state changes as possible
+ *
+ * Packets are ordered by shader, then material, then front-to-back depth, so texture binds happen
+ * once per material and opaque meshes sharing a material benefit from early depth rejection.
+ * When executing, the queue remembers the bound program, VAO, textures and per-mesh uniforms and
+ * skips anything already in place.
+ */
+class RenderQueue {
+private:
+    /**
+     * @struct Packet
+     * @brief Everything needed to draw one mesh
+     */
+    struct Packet {
+        ShaderProgram* shader;  ///< Program the mesh is drawn with, its frame uniforms already set
+        const Mesh* mesh;       ///< The mesh to draw at its selected level of detail
+        uint64_t materialKey;   ///< Material of the mesh
+        float depth;            ///< View space distance of the mesh along the view direction
+        GLsizei instanceCount;  ///< Instances read from the instance buffer, 0 if not instanced
+        bool instancedDraw;     ///< Whether all instances are drawn in one call
+    };
+
+    std::vector<Packet> packets;    ///< Packets of the frame being built
+    RenderQueueStats stats;         ///< State changes of the last executed frame
+    std::vector<GLuint> boundTextures; ///< Texture bound to each unit while executing, kept to avoid reallocating every frame
+
+public:
+    /**
+     * @brief Adds a mesh draw to the frame
+     *
+     * The mesh must stay alive and keep its level of detail until the queue is executed.
+     *
+     * @param shader Program the mesh is drawn with
+     * @param mesh The mesh to draw
+     * @param depth View space distance of the mesh, used for front-to-back ordering
+     * @param instanceCount Instances read from the instance buffer, 0 to draw the mesh once
+     * @param instancedDraw True to draw all instances in one call, false for one call per instance
+     */
+    void submit(ShaderProgram& shader, const Mesh& mesh, float depth, GLsizei instanceCount = 0, bool instancedDraw = true);
+
+    /**
+     * @brief Sorts the packets, then draws them and clears the queue
+     *
+     * Leaves no VAO bound and texture unit 0 active, like drawing each mesh directly.
+     */
+    void execute();
+
+    /**
+     * @brief Gets the state changes of the last executed frame
+     *
+     * @return The packet and state change counts
+     */
+    const RenderQueueStats& getStats() const { return stats; }
+};
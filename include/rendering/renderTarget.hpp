@@ -0,0 +1,70 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "rendering/gpuResource.hpp"
+
+/**
+ * @class RenderTarget
+ * @brief Offscreen framebuffer with a colour and a depth attachment
+ *
+ * Stands in for the default framebuffer when there is no window to draw into. The colour
+ * attachment is RGBA8 so frames can be read back without conversion, the depth attachment
+ * matches the 24 bit depth buffer requested for the window.
+ */
+class RenderTarget {
+private:
+    GlFramebuffer framebuffer;      ///< The framebuffer object
+    GlRenderbuffer colorBuffer;     ///< RGBA8 colour attachment
+    GlRenderbuffer depthBuffer;     ///< 24 bit depth attachment
+    int width = 0;                  ///< Width of the attachments in pixels
+    int height = 0;                 ///< Height of the attachments in pixels
+
+public:
+    /**
+     * @brief Creates an empty render target, see create()
+     */
+    RenderTarget() = default;
+
+    /**
+     * @brief Allocates the attachments, replacing any previous ones
+     *
+     * Leaves the default framebuffer bound.
+     *
+     * @param newWidth Width in pixels
+     * @param newHeight Height in pixels
+     * @return True if the framebuffer is complete
+     */
+    bool create(int newWidth, int newHeight);
+
+    /**
+     * @brief Releases the attachments and the framebuffer
+     */
+    void reset();
+
+    /**
+     * @brief Binds the framebuffer for drawing and reading and sets the viewport to cover it
+     */
+    void bind() const;
+
+    /**
+     * @brief Gets the OpenGL name of the framebuffer
+     *
+     * @return The framebuffer name, 0 if not created
+     */
+    GLuint getFramebuffer() const { return framebuffer.get(); }
+
+    /**
+     * @brief Gets the width of the attachments
+     *
+     * @return Width in pixels
+     */
+    int getWidth() const { return width; }
+
+    /**
+     * @brief Gets the height of the attachments
+     *
+     * @return Height in pixels
+     */
+    int getHeight() const { return height; }
+};
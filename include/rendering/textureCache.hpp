@@ -0,0 +1,181 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rendering/gpuResource.hpp"
+#include "rendering/textureLoader.hpp"
+#include "utils/constants.hpp"
+
+/**
+ * @class TextureCache
+ * @brief Process-wide cache of OpenGL textures shared by every model
+ *
+ * Textures are keyed by the canonical path of their image file plus a hash of its content, so the
+ * same file reached through different relative paths is only decoded and uploaded once. Handles are
+ * reference counted: each acquire must be paired with a release. Released textures are not deleted
+ * right away but kept resident in a least recently used list, so reloading a model shortly after
+ * switching away from it costs no decode or upload work.
+ *
+ * Lookups are thread-safe and may be done from worker threads to skip decoding. Methods creating or
+ * deleting GL objects must be called from the thread owning the GL context.
+ */
+class TextureCache {
+private:
+    /**
+     * @struct Entry
+     * @brief A texture resident on the GPU
+     */
+    struct Entry {
+        GlTexture texture;                          ///< The OpenGL texture, deleted with the entry
+        size_t refCount = 0;                        ///< Number of outstanding acquires
+        bool isReleased = false;                    ///< Whether the texture waits in the released list
+        std::list<std::string>::iterator released;  ///< Position in the released list, valid when isReleased
+    };
+
+    /**
+     * @struct FileStamp
+     * @brief Remembers the key of an image file while it stays unchanged
+     */
+    struct FileStamp {
+        int64_t modifiedTime = 0;   ///< Last write time of the file when hashed
+        uint64_t size = 0;          ///< Size of the file when hashed
+        std::string key;            ///< Cache key computed for the file
+    };
+
+    std::unordered_map<std::string, Entry> entries;        ///< Resident textures by key
+    std::unordered_map<GLuint, std::string> keys;           ///< Key of each resident texture handle
+    std::unordered_map<std::string, FileStamp> stamps;      ///< Memoized keys by file name
+    std::list<std::string> released;                        ///< Keys of unreferenced textures, most recently released first
+    size_t capacity = TEXTURE_CACHE_CAPACITY;               ///< Maximum number of unreferenced textures kept resident
+
+    size_t hits = 0;        ///< Acquires served by a resident texture
+    size_t misses = 0;      ///< Textures that had to be uploaded
+
+    mutable std::mutex mutex;   ///< Guards every member above
+
+    /**
+     * @brief Computes the cache key of an image file
+     *
+     * The content hash is only recomputed when the file's modification time or size changed.
+     *
+     * @param filename Path to the image file
+     * @return The key, or an empty string if the file cannot be read
+     */
+    std::string getKey(const std::string& filename);
+
+    /**
+     * @brief Deletes the least recently released textures until the capacity is respected
+     *
+     * The mutex must be held by the caller.
+     */
+    void evict();
+
+    /**
+     * @brief Marks a resident texture as used once more
+     *
+     * The mutex must be held by the caller.
+     *
+     * @param entry The texture entry
+     * @return The texture handle
+     */
+    GLuint addReference(Entry& entry);
+
+public:
+    /**
+     * @brief Gets the cache shared by the whole process
+     *
+     * @return The shared texture cache
+     */
+    static TextureCache& getShared();
+
+    /**
+     * @brief Checks whether the texture of an image file is resident
+     *
+     * Safe to call from any thread. A resident texture may still be evicted before it is acquired.
+     *
+     * @param filename Path to the image file
+     * @return True if the texture is on the GPU
+     */
+    bool contains(const std::string& filename);
+
+    /**
+     * @brief Acquires the resident texture of an image file
+     *
+     * @param filename Path to the image file
+     * @return The texture handle, or 0 if the texture is not resident
+     */
+    GLuint acquire(const std::string& filename);
+
+    /**
+     * @brief Uploads a decoded image and acquires the resulting texture
+     *
+     * If the texture became resident meanwhile, the existing one is acquired instead.
+     *
+     * @param image The decoded image, its filename identifies the texture
+     * @return The texture handle
+     */
+    GLuint acquire(const DecodedImage& image);
+
+    /**
+     * @brief Acquires the shared 1x1 white texture used by meshes without textures
+     *
+     * @return The texture handle
+     */
+    GLuint acquireNullTexture();
+
+    /**
+     * @brief Releases a texture acquired earlier
+     *
+     * The texture stays resident until it is evicted from the released list.
+     *
+     * @param id The texture handle
+     */
+    void release(GLuint id);
+
+    /**
+     * @brief Deletes every resident texture
+     *
+     * Must be called before the GL context is destroyed. Handles still acquired become invalid.
+     */
+    void clear();
+
+    /**
+     * @brief Sets how many unreferenced textures are kept resident
+     *
+     * @param newCapacity The maximum number of released textures, 0 deletes textures on release
+     */
+    void setCapacity(size_t newCapacity);
+
+    /**
+     * @brief Gets how many unreferenced textures are kept resident
+     *
+     * @return The capacity of the released list
+     */
+    size_t getCapacity() const;
+
+    /**
+     * @brief Gets the number of textures on the GPU
+     *
+     * @return The number of resident textures, referenced or not
+     */
+    size_t getResidentCount() const;
+
+    /**
+     * @brief Gets the number of acquires served without any upload
+     *
+     * @return The number of cache hits
+     */
+    size_t getHits() const;
+
+    /**
+     * @brief Gets the number of textures uploaded by the cache
+     *
+     * @return The number of cache misses
+     */
+    size_t getMisses() const;
+};
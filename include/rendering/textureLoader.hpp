@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "rendering/gpuResource.hpp"
+
+/**
+ * @struct ImageDeleter
+ * @brief Frees pixel buffers allocated by stb_image
+ */
+struct ImageDeleter {
+    void operator()(unsigned char* pixels) const;
+};
+
+/**
+ * @struct DecodedImage
+ * @brief Image decoded to CPU memory, waiting to be uploaded as a texture
+ */
+struct DecodedImage {
+    std::string filename;                                ///< Full path of the image file
+    int width = 0;                                       ///< Width in pixels
+    int height = 0;                                      ///< Height in pixels
+    int components = 0;                                  ///< Number of colour components per pixel
+    std::unique_ptr<unsigned char, ImageDeleter> pixels; ///< Decoded pixels, null if decoding failed
+};
+
+/**
+ * @class TextureLoader
+ * @brief Decodes texture images on worker threads and uploads them on the GL thread
+ * 
+ * Decoding (stb_image) is pure CPU work and runs concurrently on the shared thread pool.
+ * Uploading creates OpenGL objects and must be called from the thread owning the GL context.
+ */
+class TextureLoader {
+public:
+    /**
+     * @brief Decodes a single image file
+     * 
+     * @param filename Full path of the image file
+     * @return The decoded image, with null pixels if the file could not be decoded
+     */
+    static DecodedImage decode(const std::string& filename);
+
+    /**
+     * @brief Decodes several image files concurrently
+     * 
+     * @param filenames Full paths of the image files
+     * @param onDecoded Called with the index of each image once decoded, possibly from several threads
+     * @return The decoded images, in the same order as the filenames
+     */
+    static std::vector<DecodedImage> decodeAll(const std::vector<std::string>& filenames, const std::function<void(size_t)>& onDecoded = nullptr);
+
+    /**
+     * @brief Creates an OpenGL texture from a decoded image
+     * 
+     * Uploads the pixels, generates mipmaps and sets repeat wrapping with trilinear filtering.
+     * A texture object is created even if decoding failed so callers always get a valid ID.
+     * The estimated size of the texture and its mipmaps is tracked by the returned handle.
+     * 
+     * @param image The decoded image
+     * @return The handle owning the OpenGL texture
+     */
+    static GlTexture upload(const DecodedImage& image);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rendering/mesh.hpp"
+
+/**
+ * @struct PackingError
+ * @brief Largest differences between float vertices and their packed encoding
+ * 
+ * Measured by decoding the packed vertices on the CPU exactly like the vertex shader does,
+ * which serves as a diff of the packed path against the float path.
+ */
+struct PackingError {
+    float maxPositionError = 0.0f; ///< Largest position error, in model units
+    float maxNormalError = 0.0f; ///< Largest angle between original and decoded normals, in degrees
+    float maxTexCoordError = 0.0f; ///< Largest texture coordinate error
+
+    /**
+     * @brief Keeps the largest errors of both measurements
+     * 
+     * @param other Errors measured on another mesh
+     */
+    void merge(const PackingError& other);
+};
+
+/**
+ * @class VertexPacker
+ * @brief Converts float vertices to the compact PackedVertex layout and back
+ */
+class VertexPacker {
+public:
+    /**
+     * @brief Packs the vertices of a mesh
+     * 
+     * Positions are quantized against the bounds of the given vertices. Texture coordinates use
+     * unorm16 when they all lie in [0, 1], half floats otherwise.
+     * 
+     * @param vertices The float vertices
+     * @return The packed vertices, in the same order, with their decode parameters
+     */
+    static PackedVertexData pack(const std::vector<Vertex>& vertices);
+
+    /**
+     * @brief Decodes a packed vertex the same way the vertex shaders do
+     * 
+     * @param vertex The packed vertex
+     * @param quantization The decode parameters of its mesh
+     * @return The decoded float vertex
+     */
+    static Vertex unpack(const PackedVertex& vertex, const VertexQuantization& quantization);
+
+    /**
+     * @brief Measures how far the packed vertices decode from the float ones
+     * 
+     * @param vertices The float vertices
+     * @param packed The packed copy of the same vertices
+     * @return The largest errors over all vertices
+     */
+    static PackingError measureError(const std::vector<Vertex>& vertices, const PackedVertexData& packed);
+
+    /**
+     * @brief Encodes a unit vector with the octahedral mapping
+     * 
+     * @param normal The unit vector
+     * @param encoded Receives the two signed normalized components
+     */
+    static void encodeOctahedral(const glm::vec3& normal, int16_t encoded[2]);
+
+    /**
+     * @brief Decodes an octahedral encoded unit vector
+     * 
+     * @param encoded The two signed normalized components
+     * @return The unit vector
+     */
+    static glm::vec3 decodeOctahedral(const int16_t encoded[2]);
+
+    /**
+     * @brief Converts a float to an IEEE 754 half float, rounding to nearest even
+     * 
+     * @param value The float value
+     * @return The half float bits
+     */
+    static uint16_t floatToHalf(float value);
+
+    /**
+     * @brief Converts an IEEE 754 half float to a float
+     * 
+     * @param value The half float bits
+     * @return The float value
+     */
+    static float halfToFloat(uint16_t value);
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <initializer_list>
+#include <GL/glew.h>
+
+#define PROGRAM_CACHE_MAGIC 0x50475841u   // "AXGP"
+#define PROGRAM_CACHE_VERSION 1u
+#define PROGRAM_CACHE_EXTENSION ".progcache"
+
+/*
+Program cache file layout (native endianness):
+
+ProgramCacheHeader
+unsigned char[binaryLength], the driver's program binary
+*/
+
+/**
+ * @struct ProgramCacheHeader
+ * @brief Header at the start of every program cache file
+ */
+struct ProgramCacheHeader {
+    uint32_t magic;             ///< Always PROGRAM_CACHE_MAGIC
+    uint32_t version;           ///< Format version, PROGRAM_CACHE_VERSION when written
+    uint64_t key;               ///< Key the binary was stored under, guards against file name collisions
+    uint32_t binaryFormat;      ///< Driver specific format reported by glGetProgramBinary
+    uint32_t binaryLength;      ///< Size of the binary following the header
+    double compileTime;         ///< Milliseconds the program took to compile and link from source
+};
+
+/**
+ * @class ProgramCache
+ * @brief On-disk cache of linked shader program binaries
+ *
+ * After a program is compiled and linked from source, its driver binary is retrieved with
+ * glGetProgramBinary and written to CACHE_PATH. Later launches hand it back with
+ * glProgramBinary and skip compilation. Entries are keyed by the shader sources together with
+ * the GL vendor, renderer and version strings, so a driver update misses instead of feeding an
+ * incompatible binary. Drivers may still reject a binary, in which case the caller compiles
+ * from source as if the entry did not exist.
+ */
+class ProgramCache {
+private:
+    /**
+     * @brief Builds the path of the cache file for a key
+     *
+     * @param key Key of the program
+     * @return Path to the cache file within CACHE_PATH
+     */
+    static std::string getCachePath(uint64_t key);
+
+public:
+    /**
+     * @brief Checks whether the driver can save and restore program binaries
+     *
+     * @return True if GL_ARB_get_program_binary is available with at least one binary format
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Computes the cache key of a program
+     *
+     * Requires a current GL context for the driver strings.
+     *
+     * @param sources Source text of every stage, in attachment order
+     * @return The key of the program for this driver
+     */
+    static uint64_t getKey(std::initializer_list<std::string_view> sources);
+
+    /**
+     * @brief Loads a cached binary into a program object
+     *
+     * @param key Key of the program
+     * @param programID The program object to load, left unlinked if the binary is missing or rejected
+     * @param compileTime Set to the milliseconds the program took to build from source, on success
+     * @return True if the program is linked from the cached binary
+     */
+    static bool read(uint64_t key, GLuint programID, double& compileTime);
+
+    /**
+     * @brief Saves the binary of a program linked from source
+     *
+     * The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+     *
+     * @param key Key of the program
+     * @param programID The linked program object
+     * @param compileTime Milliseconds the program took to compile and link
+     * @return True if the cache file was written
+     */
+    static bool write(uint64_t key, GLuint programID, double compileTime);
+};
@@ -3,6 +3,8 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include "rendering/gpuResource.hpp"
+
 /**
  * @enum ShaderType
  * @brief Enumeration of supported GLSL shader types
@@ -29,20 +31,20 @@ enum ShaderType {
 class Shader {
 private:
     ShaderType shaderType;  ///< Type of this shader (vertex, fragment, etc.)
-    GLuint shaderID;        ///< OpenGL shader object ID
+    GlShader shader;        ///< OpenGL shader object, deleted with the Shader
 
+public:
     /**
      * @brief Reads shader source code from a file
      * 
-     * Loads the entire content of a shader source file into memory,
-     * adding a null terminator at the end.
+     * Loads the entire content of a shader source file into memory.
      * 
      * @param sourceFile Path to the shader source file
-     * @return GLchar* Pointer to null-terminated string containing shader source
+     * @param source Set to the content of the file on success
+     * @return True if the file could be read
      */
-    static const GLchar* readSourceFile(const std::string& sourceFile);
+    static bool readSourceFile(const std::string& sourceFile, std::string& source);
 
-public:
     /**
      * @brief Constructs a shader of the specified type
      * 
@@ -71,6 +73,13 @@ public:
      */
     void loadSource(const std::string& sourceFile);
 
+    /**
+     * @brief Sets the shader source code from text already in memory
+     * 
+     * @param source The GLSL source code
+     */
+    void setSource(const std::string& source);
+
     /**
      * @brief Compiles the loaded shader source code
      * 
@@ -78,22 +87,32 @@ public:
      */
     void compile();
 
+    /**
+     * @brief Submits the loaded shader source code for compilation without checking the result
+     * 
+     * With GL_KHR_parallel_shader_compile the driver compiles on its own threads and this
+     * returns immediately. Call checkCompile() once the result is needed.
+     */
+    void startCompile();
+
+    /**
+     * @brief Checks the result of the last compilation
+     * 
+     * Blocks until the compilation is done and outputs any errors to the console.
+     * 
+     * @return True if the shader compiled successfully
+     */
+    bool checkCompile() const;
+
     /**
      * @brief Gets the OpenGL shader object ID
      * @return GLuint OpenGL shader ID
      */
-    GLuint getShaderID() const { return shaderID; }
+    GLuint getShaderID() const { return shader.get(); }
 
     /**
      * @brief Gets the type of this shader
      * @return ShaderType Type of this shader
      */
     ShaderType getShaderType() const { return shaderType; }
-
-    /**
-     * @brief Destructor - cleans up OpenGL resources
-     * 
-     * Deletes the shader object from the OpenGL context.
-     */
-    ~Shader();
 };
\ No newline at end of file
@@ -1,7 +1,54 @@
 #pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
 #include <vector>
 #include <glm/glm.hpp>
+#include "rendering/gpuResource.hpp"
 #include "shader/shader.hpp"
+#include "utils/hash.hpp"
+
+/**
+ * @brief Identifier of a uniform, the 64-bit FNV-1a hash of its full name
+ */
+using UniformId = uint64_t;
+
+/**
+ * @brief Computes the identifier of a uniform name at compile time
+ * 
+ * Usage: `shader.setUniform("view"_uniform, view);`
+ */
+consteval UniformId operator""_uniform(const char* name, size_t length) {
+    return hashString(std::string_view(name, length));
+}
+
+/**
+ * @brief Computes the identifier of an array element uniform without building its name
+ * 
+ * FNV-1a hashes a name piece by piece, so `uniformId("pointLights[", 2, "].position")` equals
+ * the identifier of "pointLights[2].position".
+ * 
+ * @param prefix Name up to the opening bracket included
+ * @param index Array index
+ * @param suffix Name from the closing bracket included
+ * @return The identifier of the full name
+ */
+constexpr UniformId uniformId(std::string_view prefix, size_t index, std::string_view suffix) {
+    char digits[20] = {};
+    size_t count = 0;
+
+    do {
+        digits[count++] = char('0' + index % 10);
+        index /= 10;
+    } while (index > 0);
+
+    UniformId id = hashString(prefix);
+    for (size_t i = count; i > 0; i--) {
+        id = hashString(std::string_view(&digits[i - 1], 1), id);
+    }
+
+    return hashString(suffix, id);
+}
 
 /**
  * @class ShaderProgram
@@ -10,10 +57,82 @@
  * The ShaderProgram class encapsulates an OpenGL shader program object and provides
  * methods for attaching shaders, linking the program, and setting uniform variables.
  * It supports various data types for uniforms including integers, floats, vectors, and matrices.
+ * 
+ * Every active uniform is reflected once linked, so setting one is a table lookup by its
+ * identifier followed by a single GL call. Uniforms the program does not use are ignored.
+ * 
+ * Programs built from shader files can be deferred and advanced with poll() between frames,
+ * so only the programs needed right away delay the first frame.
  */
 class ShaderProgram {
 private:
-    GLuint programID; ///< OpenGL program object ID
+    /**
+     * @enum BuildStage
+     * @brief Progress of a program built from shader files
+     */
+    enum class BuildStage {
+        Pending,            ///< Nothing done yet
+        CompilingVertex,    ///< Sources loaded, the vertex shader compiles on the next step
+        CompilingFragment,  ///< The fragment shader compiles on the next step
+        Linking,            ///< Link submitted, done once the driver reports completion
+        Ready,              ///< Linked and usable
+        Failed              ///< Compilation or linking failed
+    };
+
+    /**
+     * @struct UniformSlot
+     * @brief Entry of the uniform table
+     */
+    struct UniformSlot {
+        UniformId id = 0;       ///< Identifier of the uniform, 0 for an empty slot
+        GLint location = -1;    ///< Location of the uniform in the program
+    };
+
+    GlProgram program; ///< OpenGL program object, deleted with the ShaderProgram
+    std::vector<UniformSlot> uniformTable; ///< Open addressing table of the active uniforms, a power of two in size
+    size_t uniformMask = 0; ///< Size of the uniform table minus one
+    bool fromBinaryCache = false; ///< Whether the program was restored from the program binary cache
+    double buildTime = 0.0; ///< Milliseconds spent reading, compiling and linking or restoring the program
+    double savedTime = 0.0; ///< Milliseconds the binary cache saved compared to building from source
+    BuildStage stage = BuildStage::Ready; ///< Build progress, programs not built from files are managed by the caller
+    std::string vertShaderPath; ///< Vertex shader file of a program built from files
+    std::string fragShaderPath; ///< Fragment shader file of a program built from files
+    std::unique_ptr<Shader> vertShader; ///< Vertex shader while the program builds
+    std::unique_ptr<Shader> fragShader; ///< Fragment shader while the program builds
+    bool cacheSupported = false; ///< Whether the binary cache is used for this program
+    uint64_t cacheKey = 0; ///< Key of the program in the binary cache
+
+    /**
+     * @brief Advances the build of a program made from shader files by one stage
+     * 
+     * Without parallel compilation each stage blocks for one shader compile or the link,
+     * which slices a build over several calls.
+     * 
+     * @param wait Whether to block until a submitted link completes instead of returning
+     */
+    void buildStep(bool wait);
+
+    /**
+     * @brief Checks the link status, then reflects the uniforms of a linked program
+     * 
+     * @return True if the program linked successfully
+     */
+    bool finishLink();
+
+    /**
+     * @brief Fills the uniform table with the active uniforms of the linked program
+     * 
+     * Arrays are reported once by GL, every element is registered along with the bare array name.
+     */
+    void reflectUniforms();
+
+    /**
+     * @brief Looks up the location of a uniform
+     * 
+     * @param id Identifier of the uniform
+     * @return The location, -1 if the program has no such active uniform
+     */
+    GLint getUniformLocation(UniformId id) const;
 
 public:
     /**
@@ -42,10 +161,14 @@ public:
      * from the specified file paths, attaches them to the program, and links it.
      * The created Shader objects are automatically deleted when they go out of scope.
      * 
+     * When the driver supports program binaries, the linked binary is cached and later
+     * launches restore it instead of compiling, falling back to the sources if rejected.
+     * 
      * @param vertShaderPath Path to the vertex shader source file
      * @param fragShaderPath Path to the fragment shader source file
+     * @param deferred True to only record the paths, the program is then built by poll() or build()
      */
-    ShaderProgram(const std::string& vertShaderPath, const std::string& fragShaderPath);
+    ShaderProgram(const std::string& vertShaderPath, const std::string& fragShaderPath, bool deferred = false);
 
     /**
      * @brief Attaches a shader to the program
@@ -72,11 +195,41 @@ public:
     /**
      * @brief Links the shader program
      * 
-     * Links all attached shaders into a program. Outputs an error message
-     * to stderr if linking fails.
+     * Links all attached shaders into a program and reflects its active uniforms.
+     * Outputs an error message to stderr if linking fails.
      */
     void link();
 
+    /**
+     * @brief Finishes building a program made from shader files, blocking until it is linked
+     */
+    void build();
+
+    /**
+     * @brief Advances a deferred build without waiting on the driver
+     * 
+     * With GL_KHR_parallel_shader_compile the first call submits both shaders and the link,
+     * and later calls only ask whether the driver is done. Otherwise each call performs one
+     * blocking stage: loading, compiling a shader, or linking.
+     * 
+     * @return True if the program is ready to use
+     */
+    bool poll();
+
+    /**
+     * @brief Checks whether the program can be used without waiting on its build
+     * 
+     * @return True if the program is linked, or failed and will not improve by waiting
+     */
+    bool isReady() const { return stage == BuildStage::Ready || stage == BuildStage::Failed; }
+
+    /**
+     * @brief Checks whether the driver compiles and links programs on its own threads
+     * 
+     * @return True if GL_KHR_parallel_shader_compile is available
+     */
+    static bool hasParallelCompile() { return GLEW_KHR_parallel_shader_compile; }
+
     /**
      * @brief Returns the OpenGL program ID
      * 
@@ -87,71 +240,97 @@ public:
     /**
      * @brief Sets an integer uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value Integer value to set
      */
-    void setUniform(const std::string& name, GLint value);
+    void setUniform(UniformId id, GLint value);
 
     /**
      * @brief Sets an unsigned integer uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value Unsigned integer value to set
      */
-    void setUniform(const std::string& name, GLuint value);
+    void setUniform(UniformId id, GLuint value);
 
     /**
      * @brief Sets a float uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value Float value to set
      */
-    void setUniform(const std::string& name, GLfloat value);
+    void setUniform(UniformId id, GLfloat value);
 
     /**
      * @brief Sets a 2D vector uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value 2D vector value to set
      */
-    void setUniform(const std::string& name, const glm::vec2& value);
+    void setUniform(UniformId id, const glm::vec2& value);
 
     /**
      * @brief Sets a 3D vector uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value 3D vector value to set
      */
-    void setUniform(const std::string& name, const glm::vec3& value);
+    void setUniform(UniformId id, const glm::vec3& value);
 
     /**
      * @brief Sets a 4D vector uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value 4D vector value to set
      */
-    void setUniform(const std::string& name, const glm::vec4& value);
+    void setUniform(UniformId id, const glm::vec4& value);
 
     /**
      * @brief Sets a 3x3 matrix uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value 3x3 matrix value to set
      */
-    void setUniform(const std::string& name, const glm::mat3& value);
+    void setUniform(UniformId id, const glm::mat3& value);
 
     /**
      * @brief Sets a 4x4 matrix uniform variable
      * 
-     * @param name Name of the uniform variable in the shader
+     * @param id Identifier of the uniform variable in the shader
      * @param value 4x4 matrix value to set
      */
-    void setUniform(const std::string& name, const glm::mat4& value);
+    void setUniform(UniformId id, const glm::mat4& value);
 
     /**
-     * @brief Destructor
+     * @brief Sets a uniform variable by name
+     * 
+     * The name is hashed on every call, prefer the identifier overloads on per-frame paths.
      * 
-     * Deletes the OpenGL shader program.
+     * @param name Name of the uniform variable in the shader
+     * @param value Value to set, of any type accepted by the identifier overloads
+     */
+    template <typename T>
+    void setUniform(std::string_view name, const T& value) { setUniform(hashString(name), value); }
+
+    /**
+     * @brief Checks whether the program was restored from the program binary cache
+     * @return True if no shader was compiled for this program
+     */
+    bool isFromBinaryCache() const { return fromBinaryCache; }
+
+    /**
+     * @brief Gets the time taken to build the program when constructed from file paths
+     * 
+     * Only time spent in the program's own calls is counted, so a parallel build
+     * reports how long it held up the caller rather than how long the driver worked.
+     * 
+     * @return Milliseconds spent reading, compiling and linking, or restoring the binary
+     */
+    double getBuildTime() const { return buildTime; }
+
+    /**
+     * @brief Gets the time the binary cache saved when constructing the program
+     * @return Milliseconds the cold build took minus the restore time, 0 if built from source
      */
-    ~ShaderProgram();
+    double getSavedTime() const { return savedTime; }
 };
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "rendering/modelSettings.hpp"
+
+/**
+ * @brief Measures the ray casting hierarchy on the Head and Triceratops models
+ * 
+ * Loads each model without a GL context, then reports the hierarchy build time and the number of
+ * random rays cast per second on one thread. Some of the rays are also tested against every
+ * triangle to check the hierarchy returns the same closest hits.
+ * 
+ * @param modelSettings The settings the models are loaded with, lean residency is ignored
+ * @return 0 if every checked ray matched, 1 otherwise
+ */
+int runBvhBenchmark(const ModelSettings& modelSettings);
@@ -12,6 +12,24 @@ enum class RotationMode {
     NATURAL_ROTATION
 };
 
+enum class CaptureMode {
+    NONE = 0,
+    TURNTABLE,      // The model turns once around the vertical axis
+    ORBIT           // The camera circles once around the model
+};
+
+enum class RenderPass {
+    MODEL = 0,
+    POINT_LIGHTS,
+    GRID,
+    UI,
+    COUNT
+};
+
+namespace RenderPassSelection {
+    constexpr const char* passes[] = { "Model", "Point Lights", "Grid", "ImGui" };
+}
+
 namespace ModelSelection {
     constexpr const char* models[] = { 
         "Backpack",
@@ -29,6 +47,27 @@ namespace ModelSelection {
 
 }
 
+enum class ImportProfile {
+    FAST = 0,
+    OPTIMIZED,
+    MAX_QUALITY
+};
+
+namespace ImportProfileSelection {
+    constexpr const char* profiles[] = { 
+        "Fast",
+        "Optimized",
+        "Max Quality"
+    };
+
+    // Names used on the command line and in cache file names
+    constexpr const char* names[] = { 
+        "fast",
+        "optimized",
+        "max-quality"
+    };
+}
+
 namespace ShaderSelection {
     constexpr const char* shaders[] = { 
         "Phong",
@@ -37,12 +76,32 @@ namespace ShaderSelection {
         "Sketch",
         "ASCII", 
     };
+
+    // Source files of each shader within ASSETS_PATH/shaders, in the order above
+    constexpr const char* vertexFiles[] = { 
+        "phongObj.vert",
+        "gouraudObj.vert",
+        "gouraudObj.vert",
+        "gouraudObj.vert",
+        "gouraudObj.vert"
+    };
+
+    constexpr const char* fragmentFiles[] = { 
+        "phongObj.frag",
+        "gouraudObj.frag",
+        "grayscale.frag",
+        "sketch.frag",
+        "ascii.frag"
+    };
 }
 
 #define AVG_MEMORY_USAGE 50.0f
 #define SCREEN_FPS 60u
 #define OPEN_GL_VERSION "#version 460"
 
+// Directive the shaders are compiled with on OpenGL 4.5 contexts, such as software rasterizers of headless runs
+#define OPEN_GL_FALLBACK_VERSION "#version 450"
+
 // TODO: Make this dependend on UI selection
 // Option: 1. Input Rotation 2. Natural Rotation
 #define MODEL_ROTATION_MODE "Input Rotation"
@@ -103,6 +162,196 @@ namespace ShaderSelection {
 // Define point light mesh size
 #define DEFAULT_POINT_LIGHT_SIZE 0.5f
 
+// Uniform buffer binding of the LightingBlock, must match the object shaders
+#define LIGHTING_UBO_BINDING 0
+
+
+/****************************************/
+/*         Model Loading Constants      */
+/****************************************/
+
+// Share of the load progress reached once the geometry is imported, then once textures are decoded
+#define LOAD_PROGRESS_IMPORTED 0.5f
+#define LOAD_PROGRESS_DECODED 0.9f
+
+// Time a frame may spend uploading a background loaded model to the GPU, in milliseconds
+#define MODEL_UPLOAD_BUDGET_MS 4.0
+
+#define DEFAULT_IMPORT_PROFILE ImportProfile::OPTIMIZED
+
+// Number of textures no longer used by any model that are kept on the GPU for quick reloads
+#define TEXTURE_CACHE_CAPACITY 64
+
+
+/****************************************/
+/*       Mesh Optimization Constants    */
+/****************************************/
+
+// Entries of the FIFO post-transform cache simulated for ACMR / ATVR statistics and clustering
+#define VERTEX_CACHE_SIZE 16u
+
+// Tom Forsyth's linear-speed vertex cache optimization parameters
+#define FORSYTH_CACHE_SIZE 32u
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+// ACMR degradation allowed when splitting triangles into clusters for overdraw sorting
+#define OVERDRAW_THRESHOLD 1.05f
+
+// Meshes with at most this many vertices are drawn with 16-bit indices
+#define MAX_SHORT_INDEX_VERTICES 65536u
+
+// Meshes that would need at most this many 16-bit parts are split when index splitting is enabled
+#define INDEX_SPLIT_MAX_PARTS 2u
+
+
+/****************************************/
+/*           LOD Constants              */
+/****************************************/
+
+// Levels of detail per mesh, including the full resolution level
+#define LOD_MAX_LEVELS 5u
+
+// Each level targets this share of the previous level's triangles
+#define LOD_REDUCTION_RATIO 0.5f
+
+// No level is generated below this many triangles
+#define LOD_MIN_TRIANGLES 64u
+
+// A level keeping more than this share of the previous level's indices ends the chain
+#define LOD_MAX_KEPT_RATIO 0.85f
+
+// Largest collapse error allowed, relative to the radius of the mesh bounds
+#define LOD_MAX_RELATIVE_ERROR 0.05f
+
+// Quadric weight of the planes keeping open borders in place
+#define LOD_BORDER_WEIGHT 10.0f
+
+// Default largest simplification error allowed on screen, in pixels
+#define LOD_PIXEL_ERROR 1.0f
+
+// Relative margin around the pixel error before switching level, avoids flickering between two levels
+#define LOD_HYSTERESIS 0.25f
+
+/****************************************/
+/*           Culling Constants          */
+/****************************************/
+
+// Meshes whose bounding sphere projects to a smaller radius are skipped, in pixels
+#define CULL_MIN_PIXEL_RADIUS 1.0f
+
+/****************************************/
+/*         Instancing Constants         */
+/****************************************/
+
+// Largest number of instances spawned from the UI
+#define MAX_INSTANCE_COUNT 4096
+
+// Distance between neighbouring instances of the UI grid, in model diameters
+#define INSTANCE_GRID_SPACING 1.25f
+
+/****************************************/
+/*           BVH Constants              */
+/****************************************/
+
+// Number of centroid bins evaluated per axis when choosing a split
+#define BVH_SAH_BINS 16u
+
+// Nodes with this many triangles or fewer always become leaves
+#define BVH_MIN_LEAF_TRIANGLES 2u
+
+// Cost of visiting a node relative to testing a triangle, used by the surface area heuristic
+#define BVH_TRAVERSAL_COST 1.0f
+
+// Maximum depth of the traversal stack
+#define BVH_STACK_SIZE 64u
+
+// Number of random rays cast per model by --bvh-benchmark
+#define BVH_BENCHMARK_RAYS 1000000u
+
+// Number of those rays also checked against every triangle
+#define BVH_BENCHMARK_CHECKED_RAYS 200u
+
+/****************************************/
+/*          Headless Constants          */
+/****************************************/
+
+// Size of the offscreen framebuffer of --headless, matches DEFAULT_ASPECT_RATIO
+#define HEADLESS_WIDTH 800
+#define HEADLESS_HEIGHT 600
+
+// Frames rendered by --headless unless --frames is given
+#define HEADLESS_DEFAULT_FRAMES 300
+
+/****************************************/
+/*          Thumbnail Constants         */
+/****************************************/
+
+// Job used for every model and shader when --batch is given no job file
+#define THUMBNAIL_DEFAULT_YAW 45.0f
+#define THUMBNAIL_DEFAULT_PITCH 20.0f
+#define THUMBNAIL_DEFAULT_SIZE 256
+
+#define THUMBNAIL_DEFAULT_OUTPUT "thumbnails"
+
+// Largest thumbnail side accepted from a job file, in pixels
+#define THUMBNAIL_MAX_SIZE 8192
+
+// Images read back but not yet encoded, per worker thread, before the GL thread waits for the encoders
+#define THUMBNAIL_PENDING_IMAGES_PER_THREAD 2
+
+/****************************************/
+/*           Capture Constants          */
+/****************************************/
+
+// Pixel buffers in the capture ring, frames in flight between the readback and the end of their encoding
+#define CAPTURE_RING_SIZE 8
+
+// Frames of a capture sequence unless --capture-frames is given, one full turn
+#define CAPTURE_DEFAULT_FRAMES 360
+
+#define CAPTURE_DEFAULT_OUTPUT "capture"
+
+// Simulated time between captured frames, in milliseconds, so sequences do not depend on the frame rate
+#define CAPTURE_TIMESTEP_MS (1000.0f / SCREEN_FPS)
+
+// Time the capture may add to a frame on the GL thread, in milliseconds
+#define CAPTURE_OVERHEAD_BUDGET_MS 1.0
+
+/****************************************/
+/*          Benchmark Constants         */
+/****************************************/
+
+// Frames measured per model and shader unless --benchmark-frames is given
+#define BENCHMARK_DEFAULT_FRAMES 300
+
+// Frames drawn before measuring each model and shader, so caches and clocks settle
+#define BENCHMARK_WARMUP_FRAMES 30
+
+// Simulated time between benchmark frames, in milliseconds
+#define BENCHMARK_TIMESTEP_MS (1000.0f / SCREEN_FPS)
+
+// Speed of the model rotation and of the camera orbit, in degrees per second
+#define BENCHMARK_ROTATION_SPEED 30.0f
+#define BENCHMARK_ORBIT_SPEED 20.0f
+
+// Report files are written to this path with .json and .csv extensions, unless --benchmark-output is given
+#define BENCHMARK_DEFAULT_OUTPUT "benchmark"
+
+// Frame timer queries in flight, frames are not throttled by vsync so results arrive later
+#define BENCHMARK_TIMER_QUERIES 4
+
+/****************************************/
+/*            Timer Constants           */
+/****************************************/
+
+// Queries per GPU timer, results are read back this many frames late at most
+#define GPU_TIMER_LATENCY 2
+
+// Queries per render pass timer, deep enough for the frames a driver queues ahead
+#define PASS_TIMER_QUERIES 4
 
 /****************************************/
 /*           Other Constants            */
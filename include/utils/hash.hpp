@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+/**
+ * @brief Hashes a block of memory using 64-bit FNV-1a
+ * 
+ * @param data Pointer to the bytes to hash
+ * @param size Number of bytes to hash
+ * @param seed Starting hash value, allows chaining several blocks into one hash
+ * @return The 64-bit hash of the bytes
+ */
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = FNV_OFFSET_BASIS) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Hashes a string using 64-bit FNV-1a, usable at compile time
+ * 
+ * @param str The string to hash
+ * @param seed Starting hash value, allows chaining several strings into one hash
+ * @return The 64-bit hash of the string
+ */
+constexpr uint64_t hashString(std::string_view str, uint64_t seed = FNV_OFFSET_BASIS) {
+    uint64_t hash = seed;
+
+    for (char c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Writes RGBA8 pixels to a PNG file
+ *
+ * Thread safe, so frames read back on the GL thread can be encoded on worker threads.
+ *
+ * @param path Path of the PNG file
+ * @param pixels Tightly packed RGBA pixels
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param bottomUp True if the first row is the bottom of the image, as read back from OpenGL
+ * @return True if the file was written
+ */
+bool writePng(const std::string& path, const unsigned char* pixels, int width, int height, bool bottomUp);
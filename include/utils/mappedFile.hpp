@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a file
+ * 
+ * Maps the whole file into the address space so its content can be read directly
+ * without copying it through stream buffers. The mapping is released when the
+ * object is destroyed.
+ */
+class MappedFile {
+private:
+    const unsigned char* data = nullptr;   ///< Start of the mapped bytes
+    size_t size = 0;                       ///< Size of the mapping in bytes
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;            ///< Windows file handle
+    void* mappingHandle = nullptr;         ///< Windows file mapping handle
+#endif
+
+    /**
+     * @brief Unmaps the file and closes any handles
+     */
+    void close();
+
+public:
+    /**
+     * @brief Maps the file at the given path
+     * 
+     * If the file cannot be opened or mapped, the object is left invalid.
+     * 
+     * @param path Path of the file to map
+     */
+    MappedFile(const std::string& path);
+
+    /**
+     * @brief Destructor, releases the mapping
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Checks if the file was mapped successfully
+     * @return True if the mapping is usable
+     */
+    bool isValid() const { return data != nullptr; }
+
+    /**
+     * @brief Gets a pointer to the start of the mapped bytes
+     * @return Pointer to the file content
+     */
+    const unsigned char* getData() const { return data; }
+
+    /**
+     * @brief Gets the size of the mapped file
+     * @return Size in bytes
+     */
+    size_t getSize() const { return size; }
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+
+#include "utils/constants.hpp"
+#include "rendering/modelSettings.hpp"
+
+/**
+ * @struct Options
+ * @brief Startup settings given on the command line
+ */
+struct Options {
+    ModelSettings modelSettings; ///< Import and residency settings of the loaded models
+    bool bvhBenchmark = false;   ///< Benchmark the ray casting hierarchy and exit instead of opening the window
+    bool headless = false;       ///< Render offscreen without a window or ImGui
+    int headlessFrames = HEADLESS_DEFAULT_FRAMES; ///< Number of frames rendered before a headless run exits
+    bool batch = false;          ///< Render a batch of thumbnails offscreen and exit
+    std::string batchJobs;       ///< Thumbnail job list, the whole catalogue if empty
+    std::string batchOutput = THUMBNAIL_DEFAULT_OUTPUT; ///< Directory the thumbnails are written to
+    CaptureMode capture = CaptureMode::NONE;            ///< Frame sequence to record, if any
+    int captureFrames = CAPTURE_DEFAULT_FRAMES;         ///< Number of frames of the sequence
+    std::string captureOutput = CAPTURE_DEFAULT_OUTPUT; ///< Directory the sequence is written to
+    bool benchmark = false;                             ///< Measure frame times of every model and shader and exit
+    int benchmarkFrames = BENCHMARK_DEFAULT_FRAMES;     ///< Frames measured per model and shader
+    std::string benchmarkOutput = BENCHMARK_DEFAULT_OUTPUT; ///< Path of the reports, without extension
+};
+
+/**
+ * @brief Parses the command line arguments
+ * 
+ * Supported arguments:
+ * - `--import-profile=<fast|optimized|max-quality>` selects the Assimp post-processing profile
+ * - `--lean` frees CPU copies of model geometry once uploaded to the GPU
+ * - `--no-mesh-optimizer` keeps the imported triangle and vertex order
+ * - `--packed-vertices` uploads vertices in the compact 16 byte layout
+ * - `--split-indices` splits meshes slightly too large for 16-bit indices
+ * - `--no-lods` skips the generation of simplified levels of detail
+ * - `--bvh-benchmark` measures the ray casting hierarchy on the Head and Triceratops models, then exits
+ * - `--headless` renders into an offscreen framebuffer of a surfaceless EGL context, without window or UI
+ * - `--frames=<n>` sets the number of frames rendered by `--headless`
+ * - `--batch[=<job list>]` renders thumbnails offscreen, of every model and shader if no job list is given
+ * - `--batch-output=<dir>` sets the directory the thumbnails are written to
+ * - `--capture=<turntable|orbit>` records a full turn of the model or of the camera as numbered PNGs, then exits
+ * - `--capture-frames=<n>` sets the number of frames of the sequence
+ * - `--capture-output=<dir>` sets the directory the sequence is written to
+ * - `--benchmark` measures uncapped CPU and GPU frame times of every model and shader, then exits
+ * - `--benchmark-frames=<n>` sets the number of frames measured per model and shader
+ * - `--benchmark-output=<path>` sets where the `.json` and `.csv` reports are written
+ * 
+ * Unknown or malformed arguments are reported and ignored.
+ * 
+ * @param argc Number of arguments
+ * @param argv Argument values, argv[0] being the program name
+ * @return The parsed options, defaults for anything not given
+ */
+Options parseOptions(int argc, char* argv[]);
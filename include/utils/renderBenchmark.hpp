@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/options.hpp"
+
+/**
+ * @struct FrameTimeStats
+ * @brief Distribution of the frame times of a benchmark run, in milliseconds
+ */
+struct FrameTimeStats {
+    double p50 = 0.0;   ///< Median frame time
+    double p95 = 0.0;   ///< 95th percentile frame time
+    double p99 = 0.0;   ///< 99th percentile frame time
+    double max = 0.0;   ///< Longest frame time
+    double mean = 0.0;  ///< Average frame time
+};
+
+/**
+ * @struct BenchmarkRun
+ * @brief Measurements of one model drawn with one shader
+ */
+struct BenchmarkRun {
+    int model;              ///< Index in ModelSelection::models
+    int shader;             ///< Index in ShaderSelection::shaders
+    size_t frames;          ///< Number of frames measured
+    FrameTimeStats cpu;     ///< Wall time of each frame on the CPU, from its start to the buffer swap
+    FrameTimeStats gpu;     ///< GPU time of each frame, from timer queries
+};
+
+/**
+ * @brief Computes the percentiles of a set of frame times
+ *
+ * Percentiles use the nearest rank, so every reported value is an actual frame time.
+ *
+ * @param times The frame times, reordered by the call
+ * @return The distribution, zeroed if there are no times
+ */
+FrameTimeStats getFrameTimeStats(std::vector<double>& times);
+
+/**
+ * @brief Measures the frame times of every model with every shader
+ *
+ * Vsync is disabled and the model rotation and camera orbit advance by BENCHMARK_TIMESTEP_MS
+ * per frame, so every run draws the same frames however fast they are produced. Each model and
+ * shader is drawn for BENCHMARK_WARMUP_FRAMES frames, then measured for the requested number of
+ * frames. GPU times are read back from timer queries a few frames late, so they never stall the
+ * frames being measured. The percentiles are written to `<output>.json` and `<output>.csv`.
+ *
+ * @param options The options holding the frame count, output path, headless flag and model settings
+ * @return 0 if the reports were written, 1 otherwise
+ */
+int runRenderBenchmark(const Options& options);
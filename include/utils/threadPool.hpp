@@ -0,0 +1,97 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed set of worker threads executing queued tasks
+ * 
+ * Used to move CPU-bound loading work (image decoding, encoding, etc) off the GL thread.
+ * Tasks never touch OpenGL, any GPU work must be handed back to the thread owning the context.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;             ///< Worker threads
+    std::queue<std::function<void()>> tasks;      ///< Tasks waiting for a worker
+    std::mutex mutex;                             ///< Guards the task queue and stop flag
+    std::condition_variable condition;            ///< Signals workers when tasks are queued or the pool stops
+    bool stopping = false;                        ///< Set when the pool is being destroyed
+
+    /**
+     * @brief Loop run by every worker, executes tasks until the pool stops
+     */
+    void workerLoop();
+
+public:
+    /**
+     * @brief Creates the pool and starts its workers
+     * 
+     * @param threadCount Number of worker threads, at least one is always created
+     */
+    ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+
+    /**
+     * @brief Finishes the queued tasks and joins the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Gets the pool shared by the whole application
+     * 
+     * The pool is created on first use with one worker per hardware thread.
+     * 
+     * @return Reference to the shared pool
+     */
+    static ThreadPool& getShared();
+
+    /**
+     * @brief Gets the number of worker threads
+     * @return The worker count
+     */
+    size_t getThreadCount() const { return workers.size(); }
+
+    /**
+     * @brief Queues a task for execution on a worker
+     * 
+     * @param task Callable taking no arguments
+     * @return Future holding the task's result
+     */
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& task) {
+        using Result = std::invoke_result_t<F>;
+
+        // packaged_task is move-only, std::function needs a copyable callable
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        condition.notify_one();
+
+        return result;
+    }
+
+    /**
+     * @brief Runs a function for every index in [0, count) across the workers
+     * 
+     * The calling thread takes part in the work, so this is safe to call from a task already
+     * running on the pool. Returns once every index has been processed.
+     * 
+     * @param count Number of indices to process
+     * @param function Called once per index, possibly concurrently
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& function);
+};
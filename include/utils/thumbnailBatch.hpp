@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/options.hpp"
+
+/**
+ * @struct ThumbnailJob
+ * @brief One image of a thumbnail batch
+ */
+struct ThumbnailJob {
+    int model;      ///< Index in ModelSelection::models
+    int shader;     ///< Index in ShaderSelection::shaders
+    float yaw;      ///< Camera angle around the vertical axis of the model, in degrees
+    float pitch;    ///< Camera elevation above the model's center, in degrees
+    int width;      ///< Image width in pixels
+    int height;     ///< Image height in pixels
+};
+
+/**
+ * @brief Reads a thumbnail job list
+ *
+ * Every line holds one job as comma separated fields:
+ * `model, shader, yaw, pitch, width, height`. Model and shader are names from
+ * ModelSelection::models and ShaderSelection::shaders, or `*` for all of them. Empty lines
+ * and lines starting with `#` are skipped. Malformed lines are reported and skipped.
+ *
+ * @param path Path to the job list
+ * @param jobs Receives the jobs, with the wildcards expanded
+ * @return True if the file could be read
+ */
+bool readThumbnailJobs(const std::string& path, std::vector<ThumbnailJob>& jobs);
+
+/**
+ * @brief Gets the default catalogue job list
+ *
+ * @return One job per model and shader, from THUMBNAIL_DEFAULT_YAW and THUMBNAIL_DEFAULT_PITCH
+ *         at THUMBNAIL_DEFAULT_SIZE pixels square
+ */
+std::vector<ThumbnailJob> getCatalogueJobs();
+
+/**
+ * @brief Renders a batch of thumbnails offscreen and writes them as PNG
+ *
+ * Creates a headless window, then renders the jobs grouped by model so each model is loaded
+ * once, while the next model loads on a worker thread. Frames are read back on the GL thread
+ * and handed to the shared thread pool for PNG encoding. The image rate is reported once every
+ * file is written.
+ *
+ * @param options The options holding the job list, the output directory and the model settings
+ * @return 0 if every image was written, 1 otherwise
+ */
+int runThumbnailBatch(const Options& options);
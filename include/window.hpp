@@ -3,8 +3,10 @@
 #include <SDL2/SDL.h>
 
 #include "lighting/lighting.hpp"
+#include "rendering/renderTarget.hpp"
 #include "object.hpp"
 #include "camera.hpp"
+#include "utils/constants.hpp"
 
 class UIHandler;
 
@@ -15,6 +17,9 @@ class UIHandler;
  * The Window class handles window creation, OpenGL initialization, ImGui setup,
  * and UI rendering. It provides functionality for performance monitoring,
  * camera controls, model manipulation, and lighting adjustments.
+ * 
+ * In headless mode there is no window: a surfaceless EGL context renders into an
+ * offscreen RenderTarget, and ImGui is never initialized.
  */
 class Window {
 private:  
@@ -28,11 +33,22 @@ private:
     float memoryHistory[MEMORY_HISTORY_SIZE] = {0}; ///< Array storing historical memory usage values
     int memoryOffset = 0;                        ///< Current position in the memory history array
 
+    // GPU pass UI graphs
+    static const int PASS_HISTORY_SIZE = 600;     ///< Size of the arrays storing pass time history
+    float passHistory[(int) RenderPass::COUNT][PASS_HISTORY_SIZE] = {}; ///< Historical GPU time of each render pass
+    int passOffset = 0;                          ///< Current position in the pass history arrays
+
     SDL_Window* window;                           ///< Pointer to the SDL window
     SDL_Surface* winSurface;                      ///< Pointer to the window surface
     bool quit;                                    ///< Flag indicating if the application should exit
     SDL_Event event;                              ///< SDL event structure for handling inputs
     SDL_GLContext mainContext;                    ///< SDL OpenGL context
+
+    bool headless;                                ///< Rendering offscreen without a window or UI
+    bool vsync;                                   ///< Swaps wait for the display refresh
+    void* eglDisplay = nullptr;                   ///< EGLDisplay of the headless context, opaque to keep EGL out of this header
+    void* eglContext = nullptr;                   ///< EGLContext of the headless context
+    RenderTarget offscreenTarget;                 ///< Framebuffer drawn into in headless mode
     
     /**
      * @brief Initializes SDL and creates a window
@@ -62,11 +78,20 @@ private:
      * Establishes the main rendering context for the window.
      */
     void createContext();
+
+    /**
+     * @brief Creates a surfaceless EGL context for headless rendering
+     * 
+     * Prefers Mesa's surfaceless platform, which needs neither a display server nor a GPU
+     * when the driver falls back to software rendering. Requests OpenGL 4.6 like the window,
+     * then 4.5. Exits if no context can be made current, or if the build has no EGL support.
+     */
+    void createHeadlessContext();
     
     /**
      * @brief Initializes OpenGL features and settings
      * 
-     * Enables V-Sync, initializes GLEW, sets clear color, and enables
+     * Enables V-Sync if requested, initializes GLEW, sets clear color, and enables
      * depth testing and alpha blending.
      */
     void initializeOpenGL();
@@ -90,22 +115,17 @@ private:
      */
     void drawUI(Camera& camera, Model& obj, Lighting& lighting, UIHandler& uiHandler);
 
-    /**
-     * @brief Gets current application memory usage
-     * 
-     * Platform-specific implementation to retrieve memory usage in megabytes.
-     * Supports Windows and Linux platforms.
-     * 
-     * @return Current memory usage in MB
-     */
-    double getMemoryUsage() const;
-    
     /**
      * @brief Renders performance metrics (FPS and memory usage)
      * 
-     * Displays current FPS, frame time, and memory usage with historical graphs.
+     * Displays current FPS, frame time, and memory usage with historical graphs, along with
+     * the triangles drawn per frame at the selected levels of detail and the state changes
+     * saved by the render queue. The GPU time of each render pass is graphed below the framerate.
+     * 
+     * @param obj The model drawn this frame
+     * @param uiHandler The UI handler holding the memory usage around the last model load, the render queue stats and the pass times
      */
-    void drawPerformanceUI();
+    void drawPerformanceUI(Model& obj, UIHandler& uiHandler);
     
     /**
      * @brief Renders camera control UI elements
@@ -143,15 +163,29 @@ public:
      * @brief Constructs a new Window with SDL, OpenGL, and ImGui initialized
      * 
      * Creates a window with default settings and initializes all required
-     * rendering subsystems.
+     * rendering subsystems. A headless window instead creates an offscreen
+     * framebuffer of HEADLESS_WIDTH x HEADLESS_HEIGHT and leaves it bound.
+     * 
+     * @param headless Render offscreen without a window or UI
+     * @param vsync Synchronize buffer swaps with the display refresh, disable to measure uncapped frame rates
      */
-    Window();
+    explicit Window(bool headless = false, bool vsync = true);
+
+    /**
+     * @brief Gets current application memory usage
+     * 
+     * Platform-specific implementation to retrieve memory usage in megabytes.
+     * Supports Windows and Linux platforms.
+     * 
+     * @return Current memory usage in MB
+     */
+    static double getMemoryUsage();
 
     /**
      * @brief Renders the ImGui interface elements
      * 
      * Prepares ImGui for a new frame, draws all UI elements, and renders
-     * the resulting interface.
+     * the resulting interface. Does nothing in headless mode.
      * 
      * @param camera Reference to the camera for UI controls
      * @param obj Reference to the model for UI controls
@@ -177,14 +211,16 @@ public:
     /**
      * @brief Swaps the front and back buffers
      * 
-     * Updates the window's displayed content after rendering.
+     * Updates the window's displayed content after rendering. In headless
+     * mode the frame's commands are flushed instead.
      */
     void swapWindow();
     
     /**
      * @brief Cleans up resources and closes the window
      * 
-     * Shuts down ImGui, destroys the GL context and SDL window.
+     * Shuts down ImGui, destroys the GL context and SDL window. In headless
+     * mode releases the offscreen framebuffer and the EGL context.
      */
     void closeWindow();
 
@@ -212,7 +248,21 @@ public:
     /**
      * @brief Gets the SDL window pointer
      * 
-     * @return Pointer to the SDL_Window
+     * @return Pointer to the SDL_Window, null in headless mode
      */
     SDL_Window* getWindow() const;
+
+    /**
+     * @brief Checks whether the window renders offscreen
+     * 
+     * @return True in headless mode
+     */
+    bool isHeadless() const;
+
+    /**
+     * @brief Gets the framebuffer drawn into in headless mode
+     * 
+     * @return The offscreen render target, empty when a window is shown
+     */
+    const RenderTarget& getRenderTarget() const;
 };
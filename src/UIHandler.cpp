@@ -1,3 +1,4 @@
+#include <cmath>
 #include <imgui.h>
 #include <imgui_impl_sdl2.h>
 #include "imgui_impl_opengl3.h"
@@ -6,9 +7,17 @@
 #include "window.hpp"
 
 #include "utils/constants.hpp"
+#include "utils/threadPool.hpp"
 #include "config.h"
 
 
+UIHandler::~UIHandler() {
+    if (modelLoad.valid()) {
+        modelLoad.wait();
+    }
+}
+
+
 void UIHandler::handleInput(Window& window, Camera& camera, Model& model) {
     SDL_Event event;
     ImGuiIO& io = ImGui::GetIO();
@@ -65,8 +74,22 @@ void UIHandler::handleInput(Window& window, Camera& camera, Model& model) {
 
             case SDL_MOUSEBUTTONDOWN: {
                 if (event.button.button == SDL_BUTTON_LEFT) {
-                    // Set relative mouse to true if cursor is on context and not on UI
-                    if (!relativeMouseMode && !io.WantCaptureMouse) {
+                    SDL_Keymod modifiers = SDL_GetModState();
+                    bool picking = !relativeMouseMode && !io.WantCaptureMouse && (modifiers & (KMOD_CTRL | KMOD_SHIFT));
+
+                    // [Ctrl + Click] picks and focuses, [Shift + Click] measures
+                    if (picking) {
+                        RayHit hit = pickModel(window, camera, model, event.button.x, event.button.y);
+
+                        if (hit.hit && (modifiers & KMOD_CTRL)) {
+                            lastPick = hit;
+                            camera.focusOn(hit.position);
+                        } else if (hit.hit) {
+                            if (measurePointCount == 2) measurePointCount = 0;
+                            measurePoints[measurePointCount++] = hit.localPosition;
+                        }
+                    } else if (!relativeMouseMode && !io.WantCaptureMouse) {
+                        // Set relative mouse to true if cursor is on context and not on UI
                         SDL_SetRelativeMouseMode(SDL_TRUE);
                         relativeMouseMode = true;
                     }
@@ -118,12 +141,83 @@ void UIHandler::handleInput(Window& window, Camera& camera, Model& model) {
     }
 }
 
-void UIHandler::changeModel(std::unique_ptr<Model>& model, Camera& camera) {
-    if (selectedModel != modelSelect) {
-        model = loadNewModel();
-        camera = Camera(model->getModelRadius(), model->getModelCenter());
-        selectedModel = modelSelect;
+bool UIHandler::changeModel(std::unique_ptr<Model>& model, Camera& camera) {
+    if (loadingModel == -1) {
+        if (selectedModel != modelSelect || selectedModelSettings != modelSettings) {
+            startModelLoad();
+        }
+
+        return false;
+    }
+
+    // Poll the disk and decode stage without blocking the frame
+    if (modelLoad.valid()) {
+        if (modelLoad.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        pendingModel = modelLoad.get();
+    }
+
+    if (!pendingModel->upload(MODEL_UPLOAD_BUDGET_MS)) {
+        return false;
+    }
+
+    model = std::move(pendingModel);
+    camera = Camera(model->getModelRadius(), model->getModelCenter());
+    lastPick = RayHit();
+    measurePointCount = 0;
+    selectedModel = loadingModel;
+    selectedModelSettings = loadingModelSettings;
+    loadingModel = -1;
+
+    // Previous model is freed by now
+    memoryAfterLoad = Window::getMemoryUsage();
+
+    return true;
+}
+
+void UIHandler::cancelModelLoad() {
+    if (modelLoad.valid()) {
+        modelLoad.wait();
+        modelLoad = std::future<std::unique_ptr<Model>>();
+    }
+
+    pendingModel.reset();
+    loadingModel = -1;
+}
+
+void UIHandler::startModelLoad() {
+    loadingModel = modelSelect;
+    loadingModelSettings = modelSettings;
+    loadProgress = 0.0f;
+    memoryBeforeLoad = Window::getMemoryUsage();
+
+    std::string path = getModelPath(loadingModel);
+    ModelSettings settings = loadingModelSettings;
+    modelLoad = ThreadPool::getShared().submit([this, path, settings]() {
+        return std::make_unique<Model>(path, settings, &loadProgress);
+    });
+}
+
+void UIHandler::changeInstances(Model& model) {
+    if ((size_t) instanceCount == model.getInstanceCount()) return;
+
+    std::vector<glm::mat4> transforms;
+
+    // Square grid on the ground plane, centered on the model
+    if (instanceCount > 1) {
+        int side = (int) std::ceil(std::sqrt((float) instanceCount));
+        float spacing = model.getModelRadius() * 2.0f * model.getModelScale() * INSTANCE_GRID_SPACING;
+
+        for (int i = 0; i < instanceCount; i++) {
+            float x = (i % side - (side - 1) * 0.5f) * spacing;
+            float z = (i / side - (side - 1) * 0.5f) * spacing;
+            transforms.push_back(glm::translate(IDENTITY_MATRIX, glm::vec3(x, 0.0f, z)));
+        }
     }
+
+    model.setInstances(transforms);
 }
 
 int UIHandler::changeShader() {
@@ -134,7 +228,25 @@ int UIHandler::changeShader() {
     return selectedShader;
 }
 
-std::unique_ptr<Model> UIHandler::loadNewModel() {
-    std::string modelName = ModelSelection::models[modelSelect];
-    return std::make_unique<Model>(std::string(ASSETS_PATH) + "models/" + modelName + "/" + modelName + ".obj");
+std::string UIHandler::getModelPath(int index) {
+    std::string modelName = ModelSelection::models[index];
+    return std::string(ASSETS_PATH) + "models/" + modelName + "/" + modelName + ".obj";
+}
+
+RayHit UIHandler::pickModel(Window& window, const Camera& camera, const Model& model, int x, int y) const {
+    int width, height;
+    SDL_GetWindowSize(window.getWindow(), &width, &height);
+    if (width <= 0 || height <= 0) return RayHit();
+
+    // Unproject the cursor on the near and far planes
+    float ndcX = 2.0f * (x + 0.5f) / width - 1.0f;
+    float ndcY = 1.0f - 2.0f * (y + 0.5f) / height;
+    glm::mat4 inverseViewProjection = glm::inverse(camera.getProjectionMatrix() * camera.getViewMatrix());
+
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::vec3(farPoint) / farPoint.w - origin;
+
+    return model.raycast(origin, direction);
 }
@@ -162,6 +162,28 @@ void Camera::moveLeft() {
     applyMovementSmoothing(targetPos);
 }
 
+void Camera::focusOn(const glm::vec3& point) {
+    if (glm::length(point - cameraPos) <= 0.0f) {
+        return;
+    }
+
+    cameraTarget = point;
+    cameraFront = glm::normalize(cameraTarget - cameraPos);
+
+    cameraDirection = glm::normalize(cameraPos - cameraTarget);
+    cameraRight = glm::normalize(glm::cross(globalUp, cameraDirection));
+    cameraUp = glm::normalize(glm::cross(cameraRight, cameraDirection));
+
+    calculateYawPitchFromVector(cameraFront);
+}
+
+void Camera::orbit(const glm::vec3& center, float angle) {
+    glm::mat4 rotation = glm::rotate(IDENTITY_MATRIX, glm::radians(angle), globalUp);
+    cameraPos = center + glm::vec3(rotation * glm::vec4(cameraPos - center, 0.0f));
+
+    focusOn(center);
+}
+
 void Camera::reset() {
     yaw = DEFAULT_YAW_ANGLE;
     pitch = DEFAULT_PITCH_ANGLE;
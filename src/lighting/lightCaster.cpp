@@ -45,25 +45,24 @@ void LightCaster::setDirection(float azimuth, float elevation) {
 }
 
 
+DirLightBlock LightCaster::getBlockData() const {
+    DirLightBlock block = {};
+    block.direction = this->direction;
+    
+    // Calculate light components using intensity and default multipliers
+    block.ambient = this->colour * DEFAULT_LIGHT_AMBIENT * this->intensity;
+    block.diffuse = this->colour * this->intensity * DEFAULT_LIGHT_DIFFUSE;
+    block.specular = this->colour * this->intensity * DEFAULT_LIGHT_SPECULAR;
+
+    return block;
+}
+
+
 /*****************************************/
 /*            Private Methods            */
 /*****************************************/
 
 
-void LightCaster::setUniformsForShaderProgram(ShaderProgram& shaderProgram) {
-    shaderProgram.setUniform("dirLight.direction", this->direction);
-    
-    // Calculate light components using intensity and default multipliers
-    glm::vec3 ambient = this->colour * DEFAULT_LIGHT_AMBIENT * this->intensity;
-    glm::vec3 diffuse = this->colour * this->intensity * DEFAULT_LIGHT_DIFFUSE;
-    glm::vec3 specular = this->colour * this->intensity * DEFAULT_LIGHT_SPECULAR;
-    
-    // Set shader uniforms
-    shaderProgram.setUniform("dirLight.ambient", ambient);
-    shaderProgram.setUniform("dirLight.diffuse", diffuse);
-    shaderProgram.setUniform("dirLight.specular", specular);
-}
-
 glm::vec3 LightCaster::anglestoDirection(float azimuth, float elevation) {
     // Convert angles from degrees to radians
     float azimuthRad = glm::radians(azimuth);
@@ -1,3 +1,5 @@
+#include <cstring>
+
 #include "lighting/lighting.hpp"
 #include "utils/constants.hpp"
 
@@ -37,8 +39,7 @@ void Lighting::addPointLight() {
     glm::vec3 position = center + cameraRight * (randX * halfWidth) + cameraUp * (randY * halfHeight);
     
     // Create and add the new point light
-    PointLight pointLight = PointLight(position, DEFAULT_POINT_LIGHT_SIZE);
-    this->pointLights.push_back(pointLight);
+    this->pointLights.emplace_back(position, DEFAULT_POINT_LIGHT_SIZE);
 }
 
 
@@ -50,32 +51,50 @@ void Lighting::drawPointLights(ShaderProgram& pointLightShader) {
     
     // Activate shader and set shared uniforms
     pointLightShader.use();
-    pointLightShader.setUniform("view", this->view);
-    pointLightShader.setUniform("projection", this->projection);
+    pointLightShader.setUniform("view"_uniform, this->view);
+    pointLightShader.setUniform("projection"_uniform, this->projection);
     
     // Draw each point light with its color
     for (PointLight& pointLight : this->pointLights) {
-        pointLightShader.setUniform("model", pointLight.getModelMatrix());
-        pointLightShader.setUniform("lightColour", pointLight.getColour());
+        pointLightShader.setUniform("model"_uniform, pointLight.getModelMatrix());
+        pointLightShader.setUniform("lightColour"_uniform, pointLight.getColour());
         pointLight.draw();
     }
 }
 
 
-void Lighting::setUniformsForShaderProgram(ShaderProgram& shaderProgram) {
-    // Set the number of active point lights
-    shaderProgram.setUniform("nr_point_lights", (int) this->pointLights.size());
-    
-    // Set uniforms for each point light
-    for (int i = 0; i < this->pointLights.size(); i++) {
-        // Transform the light position to view space for lighting calculations
-        glm::vec3 viewSpacePosition = glm::vec3(this->view * glm::vec4(this->pointLights[i].getPosition(), 1.0f));
-        shaderProgram.setUniform("pointLights[" + std::to_string(i) + "].position", viewSpacePosition);
-        
-        // Set other light properties (color, attenuation, etc.)
-        pointLights[i].setUniformsForShaderProgram(shaderProgram, std::to_string(i));
+void Lighting::updateUniformBuffer() {
+    LightingBlock block = {};
+    block.dirLight = this->lightCaster.getBlockData();
+    block.nrPointLights = (GLint) this->pointLights.size();
+
+    for (size_t i = 0; i < this->pointLights.size(); i++) {
+        block.pointLights[i] = this->pointLights[i].getBlockData(this->view);
     }
-    
-    // Set directional light uniforms
-    this->lightCaster.setUniformsForShaderProgram(shaderProgram);
-}
\ No newline at end of file
+
+    if (!uniformBuffer) {
+        uniformBuffer = GlBuffer::create();
+        glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer.get());
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(LightingBlock), &block, GL_DYNAMIC_DRAW);
+        uniformBuffer.track(GpuMemoryCategory::UniformBuffers, sizeof(LightingBlock));
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        // The object shaders declare the same binding, no per-program setup is needed
+        glBindBufferBase(GL_UNIFORM_BUFFER, LIGHTING_UBO_BINDING, uniformBuffer.get());
+    } else if (std::memcmp(&block, &uploadedBlock, sizeof(LightingBlock)) != 0) {
+        glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer.get());
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightingBlock), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    } else {
+        return;
+    }
+
+    uploadedBlock = block;
+    uniformUploads++;
+}
+
+
+void Lighting::cleanup() {
+    uniformBuffer.reset();
+    pointLights.clear();
+}
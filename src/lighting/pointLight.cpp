@@ -19,27 +19,29 @@ PointLight::PointLight(glm::vec3 position, float size) : Object(position) {
 }
 
 void PointLight::draw() {
-    glBindVertexArray(VAO);
+    glBindVertexArray(VAO.get());
     glDrawElements(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 }
 
-void PointLight::setUniformsForShaderProgram(ShaderProgram& shaderProgram, const std::string& i) {
-    glm::vec3 ambient = this->colour * DEFAULT_LIGHT_AMBIENT * this->intensity; 
+PointLightBlock PointLight::getBlockData(const glm::mat4& view) const {
+    PointLightBlock block = {};
+
+    // Lighting is computed in view space
+    block.position = glm::vec3(view * glm::vec4(this->position, 1.0f));
+
+    block.ambient = this->colour * DEFAULT_LIGHT_AMBIENT * this->intensity; 
     
-    glm::vec3 diffuse = this->colour * this->intensity * DEFAULT_LIGHT_DIFFUSE; 
+    block.diffuse = this->colour * this->intensity * DEFAULT_LIGHT_DIFFUSE; 
     
     // White-tinted version of the light color
-    glm::vec3 specular = glm::mix(this->colour, glm::vec3(1.0f), 0.5f) * this->intensity * DEFAULT_LIGHT_SPECULAR;
-    
-    // Set the uniforms
-    shaderProgram.setUniform("pointLights[" + i + "].ambient", ambient);
-    shaderProgram.setUniform("pointLights[" + i + "].diffuse", diffuse);
-    shaderProgram.setUniform("pointLights[" + i + "].specular", specular);
+    block.specular = glm::mix(this->colour, glm::vec3(1.0f), 0.5f) * this->intensity * DEFAULT_LIGHT_SPECULAR;
+
+    block.constant = this->constant;
+    block.linear = this->linear;
+    block.quadratic = this->quadratic;
 
-    shaderProgram.setUniform("pointLights[" + i + "].constant", this->constant);
-    shaderProgram.setUniform("pointLights[" + i + "].linear", this->linear);
-    shaderProgram.setUniform("pointLights[" + i + "].quadratic", this->quadratic);
+    return block;
 }
 
 
@@ -50,23 +52,25 @@ void PointLight::setUniformsForShaderProgram(ShaderProgram& shaderProgram, const
 
 void PointLight::setupLightMesh(float size) {
     // Generate OpenGL objects for rendering
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    VAO = GlVertexArray::create();
+    VBO = GlBuffer::create();
+    EBO = GlBuffer::create();
     
     // Bind the Vertex Array Object first
-    glBindVertexArray(VAO);
+    glBindVertexArray(VAO.get());
     
     // Set up the vertex buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
     std::vector<glm::vec3> vertices = getCubeVertices(size);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
+    VBO.track(GpuMemoryCategory::VertexBuffers, vertices.size() * sizeof(glm::vec3));
     
     // Set up the element buffer (indices)
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
     std::vector<GLuint> indices = getCubeIndices();
     nIndices = indices.size();
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+    EBO.track(GpuMemoryCategory::IndexBuffers, indices.size() * sizeof(GLuint));
     
     // Configure vertex attribute pointers
     // Position attribute (layout location = 0)
@@ -1,3 +1,5 @@
+#include <chrono>
+#include <iostream>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_timer.h>
 #include <GL/glew.h>
@@ -8,31 +10,61 @@
 #include "camera.hpp"
 #include "window.hpp"
 #include "UIHandler.hpp"
+#include "rendering/frameCapture.hpp"
+#include "rendering/gpuResource.hpp"
 #include "rendering/model.hpp"
+#include "rendering/passTimers.hpp"
+#include "rendering/renderQueue.hpp"
+#include "rendering/textureCache.hpp"
 #include "shader/shaderProgram.hpp"
 #include "lighting/lighting.hpp"
 #include "utils/constants.hpp"
+#include "utils/options.hpp"
+#include "utils/bvhBenchmark.hpp"
+#include "utils/thumbnailBatch.hpp"
+#include "utils/renderBenchmark.hpp"
 
 
 int main(int argc, char* argv[]) {
 
-    Window window = Window();
+    Options options = parseOptions(argc, argv);
+
+    // CPU only, runs before any window or GL context exists
+    if (options.bvhBenchmark) {
+        return runBvhBenchmark(options.modelSettings);
+    }
+
+    // Creates its own window without vsync, headless if requested
+    if (options.benchmark) {
+        return runRenderBenchmark(options);
+    }
+
+    // Creates its own headless window
+    if (options.batch) {
+        return runThumbnailBatch(options);
+    }
+
+    auto startupStart = std::chrono::steady_clock::now();
+    Window window = Window(options.headless);
+    auto windowEnd = std::chrono::steady_clock::now();
     
     // ============================ INITIALIZATION SECTION =====================================
 
-    UIHandler uiHandler;
+    UIHandler uiHandler(options);
 
     // gouraud lighting shader
-    ShaderProgram gouraudShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/gouraudObj.frag");
+    ShaderProgram gouraudShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/gouraudObj.frag", true);
 
     // phong lighting shaders
-    ShaderProgram phongShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/phongObj.vert", std::string(ASSETS_PATH) + "shaders/phongObj.frag");
-    ShaderProgram grayscaleShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/grayscale.frag");
-    ShaderProgram sketchShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/sketch.frag");
-    ShaderProgram asciiShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/ascii.frag");
+    ShaderProgram phongShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/phongObj.vert", std::string(ASSETS_PATH) + "shaders/phongObj.frag", true);
+    ShaderProgram grayscaleShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/grayscale.frag", true);
+    ShaderProgram sketchShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/sketch.frag", true);
+    ShaderProgram asciiShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/gouraudObj.vert", std::string(ASSETS_PATH) + "shaders/ascii.frag", true);
 
-    // Selectable shaders
-    ShaderProgram shaders[] = { phongShader, gouraudShader, grayscaleShader, sketchShader, asciiShader };
+    // Selectable shaders, the programs are owned above. Only the selected one is built before
+    // the first frame, the others are built in the background by the render loop
+    ShaderProgram* shaders[] = { &phongShader, &gouraudShader, &grayscaleShader, &sketchShader, &asciiShader };
+    shaders[uiHandler.getShaderSelect()]->build();
 
     // init PointLight shader
     ShaderProgram pointLightShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/pointLight.vert", std::string(ASSETS_PATH) + "shaders/pointLight.frag");
@@ -40,8 +72,12 @@ int main(int argc, char* argv[]) {
     // world grid shader
     ShaderProgram worldGridShader = ShaderProgram(std::string(ASSETS_PATH) + "shaders/worldGrid.vert", std::string(ASSETS_PATH) + "shaders/worldGrid.frag");
 
+    auto shadersEnd = std::chrono::steady_clock::now();
+
     // Create a model
-    std::unique_ptr<Model> objModel = std::make_unique<Model>(std::string(ASSETS_PATH) + "models/" + ModelSelection::models[uiHandler.getModelSelect()] + "/" + ModelSelection::models[uiHandler.getModelSelect()] + ".obj");
+    double memoryBeforeLoad = Window::getMemoryUsage();
+    std::unique_ptr<Model> objModel = std::make_unique<Model>(UIHandler::getModelPath(uiHandler.getModelSelect()), options.modelSettings);
+    uiHandler.setLoadMemoryUsage(memoryBeforeLoad, Window::getMemoryUsage());
 
     // Create a camera object
     Camera camera = Camera(objModel->getModelRadius(), objModel->getModelCenter());
@@ -49,34 +85,116 @@ int main(int argc, char* argv[]) {
     // Create a lighting object
     Lighting lighting = Lighting(&camera, objModel.get());
 
+    // Startup breakdown, the binary cache only helps from the second launch on
+    {
+        auto milliseconds = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+        auto modelEnd = std::chrono::steady_clock::now();
+
+        const ShaderProgram* programs[] = { &phongShader, &gouraudShader, &grayscaleShader, &sketchShader, &asciiShader, &pointLightShader, &worldGridShader };
+        size_t builtPrograms = 0;
+        size_t cachedPrograms = 0;
+        double compileSaved = 0.0;
+        for (const ShaderProgram* program : programs) {
+            builtPrograms += program->isReady();
+            cachedPrograms += program->isFromBinaryCache();
+            compileSaved += program->getSavedTime();
+        }
+
+        std::cout << "Startup: " << milliseconds(startupStart, modelEnd) << " ms" << std::endl;
+        std::cout << "  window and context: " << milliseconds(startupStart, windowEnd) << " ms" << std::endl;
+        std::cout << "  shader programs:    " << milliseconds(windowEnd, shadersEnd) << " ms ("
+                  << builtPrograms << "/" << std::size(programs) << " built before the first frame, "
+                  << cachedPrograms << " from binary cache, " << compileSaved << " ms compile saved)" << std::endl;
+        std::cout << "  model load:         " << milliseconds(shadersEnd, modelEnd) << " ms" << std::endl;
+    }
+
     // World grid setup
-    GLuint worldGridVao;
-    glGenVertexArrays(1, &worldGridVao);
-    glBindVertexArray(worldGridVao);
+    GlVertexArray worldGridVao = GlVertexArray::create();
+    glBindVertexArray(worldGridVao.get());
     glBindVertexArray(0);
 
     // ============================ RENDERING SECTION =====================================
 
+    // Sorts the mesh draws of each frame to skip redundant state changes
+    RenderQueue renderQueue;
+
     float deltaTime = 0.0f;
     float lastFrame = 0.0f;
-    ShaderProgram currShader = shaders[uiHandler.getShaderSelect()];
+    ShaderProgram* currShader = shaders[uiHandler.getShaderSelect()];
+
+    // Headless runs render a fixed number of frames, then report the throughput
+    int renderedFrames = 0;
+    auto renderStart = std::chrono::steady_clock::now();
+
+    // Captures record the frame as drawn before the UI, at the size of the viewport
+    std::unique_ptr<FrameCapture> frameCapture;
+    if (options.capture != CaptureMode::NONE) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        frameCapture = std::make_unique<FrameCapture>(options.captureOutput, viewport[2], viewport[3]);
+
+        if (!frameCapture->isValid()) {
+            window.setQuit();
+        }
+
+        // The sequence starts from the loaded pose and is only moved by the capture steps
+        objModel->resetModel();
+    }
+
+    // Times each render pass for the Performance panel, read back frames later without waiting
+    std::unique_ptr<PassTimers> passTimers = std::make_unique<PassTimers>();
 
     while (!window.isQuit()) {
 
         // Clear depth buffer from previous iteration
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        uiHandler.changeModel(objModel, camera);
+        if (uiHandler.changeModel(objModel, camera)) {
+            lighting.setModel(objModel.get());
+        }
 
-        currShader = shaders[uiHandler.changeShader()];
+        uiHandler.changeInstances(*objModel);
 
-        float currFrame = (float) SDL_GetTicks64();
-        deltaTime = currFrame - lastFrame;
-        lastFrame = currFrame;
+        // Advance the background builds, the selected shader first. Without parallel compilation
+        // every stage blocks for a shader compile or a link, so only one stage runs per frame
+        ShaderProgram* selectedShader = shaders[uiHandler.changeShader()];
+        bool buildStepped = false;
+        if (!selectedShader->isReady()) {
+            selectedShader->poll();
+            buildStepped = true;
+        }
+
+        for (ShaderProgram* shader : shaders) {
+            if (buildStepped && !ShaderProgram::hasParallelCompile()) break;
+            if (shader->isReady()) continue;
+            shader->poll();
+            buildStepped = true;
+        }
+
+        // Keep drawing with the current shader until the selected one is built
+        if (selectedShader->isReady()) currShader = selectedShader;
+        uiHandler.setShaderCompiling(!selectedShader->isReady());
+
+        // Captured sequences advance by a fixed step so they do not depend on the frame rate
+        if (frameCapture) {
+            deltaTime = CAPTURE_TIMESTEP_MS;
+        } else {
+            float currFrame = (float) SDL_GetTicks64();
+            deltaTime = currFrame - lastFrame;
+            lastFrame = currFrame;
+        }
 
         camera.updateCameraSpeed(deltaTime);
 
-        uiHandler.handleInput(window, camera, *objModel);
+        // Input would move the camera or model mid-capture, only a quit request is honoured then
+        if (frameCapture && !window.isHeadless()) {
+            SDL_Event event;
+            while (SDL_PollEvent(&event) > 0) {
+                if (event.type == SDL_QUIT) window.setQuit();
+            }
+        } else if (!window.isHeadless()) {
+            uiHandler.handleInput(window, camera, *objModel);
+        }
 
         // Handle models and lighting
         glm::mat4 view = camera.getViewMatrix();
@@ -84,11 +202,14 @@ int main(int argc, char* argv[]) {
 
         lighting.setView(view);
         lighting.setProjection(projection);
+        lighting.updateUniformBuffer();
+        passTimers->begin(RenderPass::POINT_LIGHTS);
         lighting.drawPointLights(pointLightShader);
+        passTimers->end(RenderPass::POINT_LIGHTS);
 
         // render model
-        currShader.use();
-        if (uiHandler.getModelRotationMode() == RotationMode::NATURAL_ROTATION) {
+        currShader->use();
+        if (!frameCapture && uiHandler.getModelRotationMode() == RotationMode::NATURAL_ROTATION) {
             const float rotationSpeed = 30.0f;
     
             float rotationAngle = rotationSpeed * (deltaTime / 1000.0f); 
@@ -96,32 +217,93 @@ int main(int argc, char* argv[]) {
             objModel->rotate(rotationAngle, DEFAULT_ROTATION_AXIS);
         } 
         objModel->updateNormalMatrix(view);
-        currShader.setUniform("view", view);
-        currShader.setUniform("projection", projection);
-        currShader.setUniform("model", objModel->getModelMatrix());
-        currShader.setUniform("normalMatrix", objModel->getNormalMatrix());
-        lighting.setUniformsForShaderProgram(currShader);
-        objModel->draw(currShader);
+        currShader->setUniform("view"_uniform, view);
+        currShader->setUniform("projection"_uniform, projection);
+        currShader->setUniform("model"_uniform, objModel->getModelMatrix());
+        currShader->setUniform("normalMatrix"_uniform, objModel->getNormalMatrix());
+
+        // Skip the meshes out of view, then pick each mesh's level of detail from the model's projected size
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        objModel->cullMeshes(camera.getCameraPos(), view, projection, (float) viewport[3]);
+        objModel->selectLods(camera.getCameraPos(), projection, (float) viewport[3]);
+        passTimers->begin(RenderPass::MODEL);
+        objModel->draw(*currShader, renderQueue, view);
+        renderQueue.execute();
+        passTimers->end(RenderPass::MODEL);
+        uiHandler.setRenderQueueStats(renderQueue.getStats());
 
         // render world grid
         if (uiHandler.getShowGrid()) {
+            passTimers->begin(RenderPass::GRID);
             worldGridShader.use();
-            worldGridShader.setUniform("view", view);
-            worldGridShader.setUniform("projection", projection);
-            worldGridShader.setUniform("cameraPos", camera.getCameraPos());
-            worldGridShader.setUniform("modelRadius", objModel->getModelRadius());
-            glBindVertexArray(worldGridVao);
+            worldGridShader.setUniform("view"_uniform, view);
+            worldGridShader.setUniform("projection"_uniform, projection);
+            worldGridShader.setUniform("cameraPos"_uniform, camera.getCameraPos());
+            worldGridShader.setUniform("modelRadius"_uniform, objModel->getModelRadius());
+            glBindVertexArray(worldGridVao.get());
             glDrawArrays(GL_TRIANGLES, 0, 6);
             glDrawArrays(GL_LINES, 6, 2);
+            passTimers->end(RenderPass::GRID);
+        }
+
+        if (frameCapture) {
+            frameCapture->capture(window.isHeadless() ? window.getRenderTarget().getFramebuffer() : 0);
+
+            // One full turn over the sequence, the next frame is drawn one step further
+            float captureStep = 360.0f / options.captureFrames;
+            if (options.capture == CaptureMode::TURNTABLE) {
+                objModel->rotate(captureStep, DEFAULT_GLOBAL_UP);
+            } else {
+                camera.orbit(objModel->getModelCenter(), captureStep);
+            }
+
+            if (frameCapture->getCapturedFrames() >= options.captureFrames) {
+                window.setQuit();
+            }
         }
 
         // Render UI
+        passTimers->begin(RenderPass::UI);
         window.renderImGui(camera, *objModel, lighting, uiHandler);
+        passTimers->end(RenderPass::UI);
+
+        // Collect the pass times of earlier frames, shown by the next UI frame
+        passTimers->endFrame();
+        uiHandler.setGpuPassTimes(passTimers->getTimes());
 
         // OpenGL double buffering buffer swap
         window.swapWindow();
+
+        // A capture decides the length of a headless run
+        if (window.isHeadless() && !frameCapture && ++renderedFrames >= options.headlessFrames) {
+            window.setQuit();
+        }
+    }
+
+    if (frameCapture) {
+        frameCapture->finish();
+        frameCapture->printReport();
+        frameCapture.reset();
     }
 
+    if (window.isHeadless() && renderedFrames > 0) {
+        glFinish();
+        double renderTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+        const RenderTarget& target = window.getRenderTarget();
+
+        std::cout << "Headless: " << renderedFrames << " frames at " << target.getWidth() << "x" << target.getHeight()
+                  << " in " << renderTime << " ms (" << renderedFrames * 1000.0 / renderTime << " fps)" << std::endl;
+    }
+
+    // Release GPU resources while the context still exists, a model switch in flight included
+    uiHandler.cancelModelLoad();
+    passTimers.reset();
+    objModel.reset();
+    lighting.cleanup();
+    worldGridVao.reset();
+    TextureCache::getShared().clear();
+
     window.closeWindow();
 
     return 0;
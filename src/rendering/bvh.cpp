@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BVH_USE_SSE
+#endif
+
+#include "rendering/bvh.hpp"
+
+
+/**
+ * @brief Half the surface area of a box, the factor cancels out in the heuristic
+ */
+static float halfArea(const glm::vec3& minBounds, const glm::vec3& maxBounds) {
+    glm::vec3 extent = maxBounds - minBounds;
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+void Bvh::build(const std::vector<MeshData>& meshes) {
+    nodes.clear();
+    triangles.clear();
+
+    size_t triangleCount = 0;
+    for (const MeshData& meshData : meshes) {
+        triangleCount += meshData.indices.size() / 3;
+    }
+
+    triangles.reserve(triangleCount);
+    std::vector<glm::vec3> centroids;
+    centroids.reserve(triangleCount);
+
+    for (size_t m = 0; m < meshes.size(); m++) {
+        const MeshData& meshData = meshes[m];
+
+        for (size_t t = 0; t + 2 < meshData.indices.size(); t += 3) {
+            const glm::vec3& p0 = meshData.vertices[meshData.indices[t]].position;
+            const glm::vec3& p1 = meshData.vertices[meshData.indices[t + 1]].position;
+            const glm::vec3& p2 = meshData.vertices[meshData.indices[t + 2]].position;
+
+            triangles.push_back({ p0, p1 - p0, p2 - p0, uint32_t(m), uint32_t(t / 3) });
+            centroids.push_back((p0 + p1 + p2) / 3.0f);
+        }
+    }
+
+    if (triangles.empty()) return;
+
+    // A binary tree over n leaves has at most 2n - 1 nodes, so references into the array stay valid
+    nodes.reserve(triangles.size() * 2);
+    nodes.push_back({ glm::vec3(0.0f), 0, glm::vec3(0.0f), uint32_t(triangles.size()) });
+    fitBounds(nodes[0]);
+
+    // Node index and depth, the depth is bounded so traversals never overflow their stack
+    std::vector<std::pair<uint32_t, uint32_t>> pending = { { 0, 0 } };
+
+    while (!pending.empty()) {
+        auto [index, depth] = pending.back();
+        pending.pop_back();
+
+        Node& node = nodes[index];
+        if (node.count <= BVH_MIN_LEAF_TRIANGLES || depth + 1 >= BVH_STACK_SIZE) continue;
+
+        int axis;
+        float splitPosition;
+        float cost = findSplit(node, centroids, axis, splitPosition);
+
+        // Testing every triangle of the leaf costs one unit each
+        if (cost >= float(node.count)) continue;
+
+        uint32_t first = node.leftFirst;
+        uint32_t i = first;
+        uint32_t j = first + node.count;
+
+        while (i < j) {
+            if (centroids[i][axis] < splitPosition) {
+                i++;
+            } else {
+                j--;
+                std::swap(triangles[i], triangles[j]);
+                std::swap(centroids[i], centroids[j]);
+            }
+        }
+
+        uint32_t leftCount = i - first;
+        if (leftCount == 0 || leftCount == node.count) continue;
+
+        uint32_t left = uint32_t(nodes.size());
+        nodes.push_back({ glm::vec3(0.0f), first, glm::vec3(0.0f), leftCount });
+        nodes.push_back({ glm::vec3(0.0f), i, glm::vec3(0.0f), node.count - leftCount });
+        fitBounds(nodes[left]);
+        fitBounds(nodes[left + 1]);
+
+        node.leftFirst = left;
+        node.count = 0;
+
+        pending.push_back({ left + 1, depth + 1 });
+        pending.push_back({ left, depth + 1 });
+    }
+}
+
+RayHit Bvh::intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const {
+    RayHit hit;
+    if (nodes.empty()) return hit;
+
+    glm::vec3 inverseDirection = glm::vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float closest = maxDistance;
+
+    if (intersectBox(nodes[0], origin, inverseDirection, closest) == INFINITY) return hit;
+
+    // Far children waiting to be visited along with their entry distance
+    std::pair<const Node*, float> stack[BVH_STACK_SIZE];
+    size_t stackSize = 0;
+    const Node* node = &nodes[0];
+
+    while (true) {
+        if (node->count > 0) {
+            for (uint32_t i = node->leftFirst; i < node->leftFirst + node->count; i++) {
+                float distance = intersectTriangle(triangles[i], origin, direction, closest);
+                if (distance < closest) {
+                    closest = distance;
+                    hit.hit = true;
+                    hit.meshIndex = triangles[i].meshIndex;
+                    hit.triangleIndex = triangles[i].triangleIndex;
+                }
+            }
+
+            node = nullptr;
+        } else {
+            // Visit the nearest child first so the closest hit shrinks the ray early
+            const Node* nearChild = &nodes[node->leftFirst];
+            const Node* farChild = nearChild + 1;
+            float nearDistance = intersectBox(*nearChild, origin, inverseDirection, closest);
+            float farDistance = intersectBox(*farChild, origin, inverseDirection, closest);
+
+            if (farDistance < nearDistance) {
+                std::swap(nearChild, farChild);
+                std::swap(nearDistance, farDistance);
+            }
+
+            node = nearDistance == INFINITY ? nullptr : nearChild;
+            if (farDistance != INFINITY) {
+                stack[stackSize++] = { farChild, farDistance };
+            }
+        }
+
+        // Skip the pending nodes that start beyond the closest hit found since they were pushed
+        while (!node && stackSize > 0) {
+            auto [pendingNode, entry] = stack[--stackSize];
+            if (entry < closest) node = pendingNode;
+        }
+
+        if (!node) break;
+    }
+
+    if (hit.hit) hit.distance = closest;
+    return hit;
+}
+
+RayHit Bvh::intersectBruteForce(const glm::vec3& origin, const glm::vec3& direction) const {
+    RayHit hit;
+    float closest = INFINITY;
+
+    for (const Triangle& triangle : triangles) {
+        float distance = intersectTriangle(triangle, origin, direction, closest);
+        if (distance < closest) {
+            closest = distance;
+            hit.hit = true;
+            hit.meshIndex = triangle.meshIndex;
+            hit.triangleIndex = triangle.triangleIndex;
+        }
+    }
+
+    if (hit.hit) hit.distance = closest;
+    return hit;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+float Bvh::findSplit(const Node& node, const std::vector<glm::vec3>& centroids, int& axis, float& splitPosition) const {
+    float nodeArea = halfArea(node.minBounds, node.maxBounds);
+    if (nodeArea <= 0.0f) return INFINITY;
+
+    glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+    glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+    for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+        centroidMin = glm::min(centroidMin, centroids[i]);
+        centroidMax = glm::max(centroidMax, centroids[i]);
+    }
+
+    // Bin the triangles along the three axes in a single pass
+    glm::vec3 binMin[3][BVH_SAH_BINS];
+    glm::vec3 binMax[3][BVH_SAH_BINS];
+    uint32_t binCount[3][BVH_SAH_BINS] = {};
+    glm::vec3 extent = centroidMax - centroidMin;
+    glm::vec3 scale = glm::vec3(0.0f);
+
+    for (int a = 0; a < 3; a++) {
+        std::fill(binMin[a], binMin[a] + BVH_SAH_BINS, glm::vec3(FLT_MAX));
+        std::fill(binMax[a], binMax[a] + BVH_SAH_BINS, glm::vec3(-FLT_MAX));
+        if (extent[a] > 0.0f) scale[a] = float(BVH_SAH_BINS) / extent[a];
+    }
+
+    for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+        const Triangle& triangle = triangles[i];
+        glm::vec3 p1 = triangle.v0 + triangle.edge1;
+        glm::vec3 p2 = triangle.v0 + triangle.edge2;
+        glm::vec3 triangleMin = glm::min(triangle.v0, glm::min(p1, p2));
+        glm::vec3 triangleMax = glm::max(triangle.v0, glm::max(p1, p2));
+
+        for (int a = 0; a < 3; a++) {
+            uint32_t bin = std::min(uint32_t((centroids[i][a] - centroidMin[a]) * scale[a]), BVH_SAH_BINS - 1);
+            binMin[a][bin] = glm::min(binMin[a][bin], triangleMin);
+            binMax[a][bin] = glm::max(binMax[a][bin], triangleMax);
+            binCount[a][bin]++;
+        }
+    }
+
+    float bestCost = INFINITY;
+
+    for (int a = 0; a < 3; a++) {
+        if (extent[a] <= 0.0f) continue;
+
+        // Sweep from the left, then from the right, pricing every plane between two bins
+        float leftCost[BVH_SAH_BINS - 1];
+        glm::vec3 sweepMin = glm::vec3(FLT_MAX);
+        glm::vec3 sweepMax = glm::vec3(-FLT_MAX);
+        uint32_t sweepCount = 0;
+
+        for (uint32_t b = 0; b + 1 < BVH_SAH_BINS; b++) {
+            sweepMin = glm::min(sweepMin, binMin[a][b]);
+            sweepMax = glm::max(sweepMax, binMax[a][b]);
+            sweepCount += binCount[a][b];
+            leftCost[b] = sweepCount > 0 ? sweepCount * halfArea(sweepMin, sweepMax) : 0.0f;
+        }
+
+        sweepMin = glm::vec3(FLT_MAX);
+        sweepMax = glm::vec3(-FLT_MAX);
+        sweepCount = 0;
+
+        for (uint32_t b = BVH_SAH_BINS - 1; b > 0; b--) {
+            sweepMin = glm::min(sweepMin, binMin[a][b]);
+            sweepMax = glm::max(sweepMax, binMax[a][b]);
+            sweepCount += binCount[a][b];
+            if (sweepCount == 0 || sweepCount == node.count) continue;
+
+            float cost = BVH_TRAVERSAL_COST + (leftCost[b - 1] + sweepCount * halfArea(sweepMin, sweepMax)) / nodeArea;
+            if (cost < bestCost) {
+                bestCost = cost;
+                axis = a;
+                splitPosition = centroidMin[a] + extent[a] * float(b) / float(BVH_SAH_BINS);
+            }
+        }
+    }
+
+    return bestCost;
+}
+
+void Bvh::fitBounds(Node& node) const {
+    node.minBounds = glm::vec3(FLT_MAX);
+    node.maxBounds = glm::vec3(-FLT_MAX);
+
+    for (uint32_t i = node.leftFirst; i < node.leftFirst + node.count; i++) {
+        const Triangle& triangle = triangles[i];
+        glm::vec3 p1 = triangle.v0 + triangle.edge1;
+        glm::vec3 p2 = triangle.v0 + triangle.edge2;
+
+        node.minBounds = glm::min(node.minBounds, glm::min(triangle.v0, glm::min(p1, p2)));
+        node.maxBounds = glm::max(node.maxBounds, glm::max(triangle.v0, glm::max(p1, p2)));
+    }
+}
+
+float Bvh::intersectBox(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance) {
+#ifdef BVH_USE_SSE
+    // All three slabs at once, the fourth lane holds the node links and is left out of the reductions
+    __m128 rayOrigin = _mm_set_ps(0.0f, origin.z, origin.y, origin.x);
+    __m128 rayInverse = _mm_set_ps(0.0f, inverseDirection.z, inverseDirection.y, inverseDirection.x);
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.minBounds.x), rayOrigin), rayInverse);
+    __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.maxBounds.x), rayOrigin), rayInverse);
+    __m128 near = _mm_min_ps(t1, t2);
+    __m128 far = _mm_max_ps(t1, t2);
+
+    __m128 entryVector = _mm_max_ss(near, _mm_max_ss(_mm_shuffle_ps(near, near, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                     _mm_shuffle_ps(near, near, _MM_SHUFFLE(2, 2, 2, 2))));
+    __m128 exitVector = _mm_min_ss(far, _mm_min_ss(_mm_shuffle_ps(far, far, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                   _mm_shuffle_ps(far, far, _MM_SHUFFLE(2, 2, 2, 2))));
+    float entry = _mm_cvtss_f32(entryVector);
+    float exit = _mm_cvtss_f32(exitVector);
+#else
+    glm::vec3 t1 = (node.minBounds - origin) * inverseDirection;
+    glm::vec3 t2 = (node.maxBounds - origin) * inverseDirection;
+    glm::vec3 near = glm::min(t1, t2);
+    glm::vec3 far = glm::max(t1, t2);
+
+    float entry = std::max(near.x, std::max(near.y, near.z));
+    float exit = std::min(far.x, std::min(far.y, far.z));
+#endif
+
+    if (exit < std::max(entry, 0.0f) || entry >= maxDistance) return INFINITY;
+    return entry;
+}
+
+float Bvh::intersectTriangle(const Triangle& triangle, const glm::vec3& origin, const glm::vec3& direction, float maxDistance) {
+    glm::vec3 p = glm::cross(direction, triangle.edge2);
+    float determinant = glm::dot(triangle.edge1, p);
+
+    // Parallel to the triangle's plane, both faces are hit otherwise
+    if (determinant == 0.0f) return INFINITY;
+    float inverseDeterminant = 1.0f / determinant;
+
+    glm::vec3 s = origin - triangle.v0;
+    float u = glm::dot(s, p) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) return INFINITY;
+
+    glm::vec3 q = glm::cross(s, triangle.edge1);
+    float v = glm::dot(direction, q) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) return INFINITY;
+
+    float distance = glm::dot(triangle.edge2, q) * inverseDeterminant;
+    if (distance <= 0.0f || distance >= maxDistance) return INFINITY;
+
+    return distance;
+}
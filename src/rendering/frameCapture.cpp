@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+#include "rendering/frameCapture.hpp"
+#include "utils/imageWriter.hpp"
+#include "utils/threadPool.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+FrameCapture::FrameCapture(const std::string& directory, int width, int height, size_t ringSize)
+    : directory(directory), width(width), height(height) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "FrameCapture: failed to create " << directory << ": " << error.message() << std::endl;
+        return;
+    }
+
+    size_t frameBytes = (size_t) width * height * 4;
+    slots.resize(ringSize);
+
+    // Persistent mapping lets the encoders read the frames in place while the ring keeps going
+    for (Slot& slot : slots) {
+        slot.buffer = GlBuffer::create();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+        glBufferStorage(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_CLIENT_STORAGE_BIT);
+        slot.buffer.track(GpuMemoryCategory::ReadbackBuffers, frameBytes);
+        slot.pixels = static_cast<const unsigned char*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+
+        if (!slot.pixels) {
+            std::cerr << "FrameCapture: failed to map the readback buffers" << std::endl;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            finish();
+            return;
+        }
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    valid = true;
+}
+
+FrameCapture::~FrameCapture() {
+    finish();
+}
+
+void FrameCapture::capture(GLuint framebuffer) {
+    if (!valid) return;
+
+    auto start = std::chrono::steady_clock::now();
+    Slot& slot = slots[nextSlot];
+
+    // The whole ring is in flight, the oldest frame has to be finished before its buffer is reused
+    if (slot.fence || slot.encoded.valid()) {
+        if (slot.fence) encode(slot, true);
+        collect(slot);
+        ringWait += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = capturedFrames++;
+    nextSlot = (nextSlot + 1) % slots.size();
+
+    // Hand over the earlier frames whose readback already completed, without waiting
+    for (Slot& other : slots) {
+        if (!other.fence) continue;
+
+        GLenum status = glClientWaitSync(other.fence, 0, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+            encode(other, false);
+        }
+    }
+
+    double overhead = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    totalOverhead += overhead;
+    maxOverhead = std::max(maxOverhead, overhead);
+    overBudgetFrames += overhead > CAPTURE_OVERHEAD_BUDGET_MS;
+}
+
+void FrameCapture::finish() {
+    // Oldest first, so frames are written in order when the workers are saturated
+    for (size_t i = 0; i < slots.size(); i++) {
+        Slot& slot = slots[(nextSlot + i) % slots.size()];
+        if (slot.fence) encode(slot, true);
+    }
+
+    for (Slot& slot : slots) {
+        if (slot.encoded.valid()) collect(slot);
+
+        if (slot.pixels) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.pixels = nullptr;
+        }
+    }
+
+    slots.clear();
+    nextSlot = 0;
+    valid = false;
+}
+
+void FrameCapture::printReport() const {
+    std::cout << "Capture: " << writtenFrames << "/" << capturedFrames << " frames of " << width << "x" << height
+              << " written to " << directory << std::endl;
+    std::cout << "  overhead per frame: " << getAverageOverhead() << " ms average, " << maxOverhead << " ms max, budget "
+              << CAPTURE_OVERHEAD_BUDGET_MS << " ms, " << overBudgetFrames << " frames over budget" << std::endl;
+    std::cout << "  waited " << ringWait << " ms for a free readback buffer" << std::endl;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+void FrameCapture::encode(Slot& slot, bool wait) {
+    if (wait) {
+        // Flushing makes sure the fence is submitted, or the wait could never end
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {}
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", slot.frame);
+    std::string path = (std::filesystem::path(directory) / name).string();
+
+    const unsigned char* pixels = slot.pixels;
+    int frameWidth = width;
+    int frameHeight = height;
+    slot.encoded = ThreadPool::getShared().submit([path, pixels, frameWidth, frameHeight]() {
+        return writePng(path, pixels, frameWidth, frameHeight, true);
+    });
+}
+
+void FrameCapture::collect(Slot& slot) {
+    if (slot.encoded.get()) {
+        writtenFrames++;
+    } else {
+        failedFrames++;
+    }
+}
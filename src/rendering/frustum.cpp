@@ -0,0 +1,48 @@
+#include "rendering/frustum.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+Frustum::Frustum(const glm::mat4& matrix) {
+    // Rows of the matrix, glm is column major
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+    }
+
+    planes[0] = rows[3] + rows[0]; // left
+    planes[1] = rows[3] - rows[0]; // right
+    planes[2] = rows[3] + rows[1]; // bottom
+    planes[3] = rows[3] - rows[1]; // top
+    planes[4] = rows[3] + rows[2]; // near
+    planes[5] = rows[3] - rows[2]; // far
+
+    // Normalized so plane equations give distances
+    for (glm::vec4& plane : planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
+
+bool Frustum::intersectsSphere(const glm::vec3& center, float radius) const {
+    for (const glm::vec4& plane : planes) {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+
+    return true;
+}
+
+bool Frustum::intersectsBox(const glm::vec3& minBounds, const glm::vec3& maxBounds) const {
+    for (const glm::vec4& plane : planes) {
+        // Corner furthest along the plane normal
+        glm::vec3 positive(plane.x >= 0.0f ? maxBounds.x : minBounds.x,
+                           plane.y >= 0.0f ? maxBounds.y : minBounds.y,
+                           plane.z >= 0.0f ? maxBounds.z : minBounds.z);
+
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) return false;
+    }
+
+    return true;
+}
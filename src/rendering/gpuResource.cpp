@@ -0,0 +1,41 @@
+#include <iostream>
+
+#include "rendering/gpuResource.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+GpuMemoryRegistry& GpuMemoryRegistry::getShared() {
+    static GpuMemoryRegistry registry;
+    return registry;
+}
+
+void GpuMemoryRegistry::add(GpuMemoryCategory category, size_t size) {
+    bytes[(size_t) category] += size;
+    objects[(size_t) category]++;
+}
+
+void GpuMemoryRegistry::remove(GpuMemoryCategory category, size_t size) {
+    size_t index = (size_t) category;
+
+    if (objects[index] == 0 || bytes[index] < size) {
+        std::cerr << "GpuMemoryRegistry: released more memory than recorded" << std::endl;
+        bytes[index] = 0;
+        objects[index] = 0;
+        return;
+    }
+
+    bytes[index] -= size;
+    objects[index]--;
+}
+
+size_t GpuMemoryRegistry::getTotalBytes() const {
+    size_t total = 0;
+    for (size_t categoryBytes : bytes) {
+        total += categoryBytes;
+    }
+    return total;
+}
@@ -0,0 +1,80 @@
+#include "rendering/gpuTimer.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+GpuTimer::GpuTimer(size_t latency) {
+    queries.reserve(latency);
+    for (size_t i = 0; i < latency; i++) {
+        queries.push_back(GlQuery::create());
+    }
+}
+
+void GpuTimer::begin() {
+    // The ring is full, the oldest query has to be read before it is reused
+    if (pendingQueries == queries.size()) {
+        readOldest(true);
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[nextQuery].get());
+}
+
+bool GpuTimer::tryBegin() {
+    update();
+    if (pendingQueries == queries.size()) return false;
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[nextQuery].get());
+    return true;
+}
+
+void GpuTimer::end() {
+    glEndQuery(GL_TIME_ELAPSED);
+
+    nextQuery = (nextQuery + 1) % queries.size();
+    pendingQueries++;
+}
+
+void GpuTimer::update() {
+    while (pendingQueries > 0 && readOldest(false)) {}
+}
+
+void GpuTimer::finish() {
+    while (pendingQueries > 0) {
+        readOldest(true);
+    }
+}
+
+bool GpuTimer::takeResult(double& milliseconds) {
+    if (results.empty()) return false;
+
+    milliseconds = results.front();
+    results.pop_front();
+    return true;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+bool GpuTimer::readOldest(bool wait) {
+    GLuint query = queries[(nextQuery + queries.size() - pendingQueries) % queries.size()].get();
+
+    if (!wait) {
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return false;
+    }
+
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+
+    latestTime = nanoseconds / 1000000.0;
+    results.push_back(latestTime);
+    pendingQueries--;
+    return true;
+}
@@ -1,46 +1,108 @@
 #include <GL/glew.h>
 
 #include "rendering/mesh.hpp"
-
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures, float shininess) 
-    : Mesh(vertices, indices, textures) 
-{
+#include "utils/hash.hpp"
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures, float shininess, 
+           const PackedVertexData& packed, const MeshLodChain& lodChain) {
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    this->indexCount = this->indices.size();
     this->shininess = shininess;
+
+    setupMesh(packed, lodChain);
 }
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices, std::vector<Texture> textures) {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    this->indexCount = this->indices.size();
 
     setupMesh();
 }
 
-Mesh::~Mesh() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    
-    for (const auto& texture : textures) {
-        glDeleteTextures(1, &texture.id);
+void Mesh::setupMesh(const PackedVertexData& packed, const MeshLodChain& lodChain) {
+    // Meshes with the same textures and shininess share their material state
+    materialKey = hashBytes(&shininess, sizeof(shininess));
+    for (const Texture& texture : textures) {
+        materialKey = hashBytes(&texture.id, sizeof(texture.id), materialKey);
+        materialKey = hashString(texture.type, materialKey);
     }
-}
 
-void Mesh::setupMesh() {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    // The handles delete the VAO, VBO and EBO with the mesh. Textures are owned by the
+    // texture cache and released by the model
+    VAO = GlVertexArray::create();
+    VBO = GlBuffer::create();
+    EBO = GlBuffer::create();
+
+    glBindVertexArray(VAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+
+    packedLayout = !packed.vertices.empty();
 
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (packedLayout) {
+        quantization = packed.quantization;
 
-    // Store vertex data into the currently bounded VBO
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        // Store packed vertex data into the currently bounded VBO
+        glBufferData(GL_ARRAY_BUFFER, packed.vertices.size() * sizeof(PackedVertex), packed.vertices.data(), GL_STATIC_DRAW);
+        VBO.track(GpuMemoryCategory::VertexBuffers, packed.vertices.size() * sizeof(PackedVertex));
+    } else {
+        // Store vertex data into the currently bounded VBO
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+        VBO.track(GpuMemoryCategory::VertexBuffers, vertices.size() * sizeof(Vertex));
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+
+    // Every level of detail lives in the same EBO, the simplified ones after the full resolution indices
+    lods.clear();
+    lods.push_back(MeshLod{ 0, indexCount, 0.0f });
+    for (const MeshLod& level : lodChain.levels) {
+        lods.push_back(MeshLod{ GLuint(indices.size()) + level.indexOffset, level.indexCount, level.error });
+    }
+    currentLod = 0;
+
+    size_t totalIndices = indices.size() + lodChain.indices.size();
+
+    // Store indice data into the currently bounded EBO, at half the size when 16 bits are enough
+    if (fitsShortIndices(vertices.size())) {
+        std::vector<GLushort> shortIndices;
+        shortIndices.reserve(totalIndices);
+        shortIndices.assign(indices.begin(), indices.end());
+        shortIndices.insert(shortIndices.end(), lodChain.indices.begin(), lodChain.indices.end());
+        indexType = GL_UNSIGNED_SHORT;
+
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(GLushort), shortIndices.data(), GL_STATIC_DRAW);
+        EBO.track(GpuMemoryCategory::IndexBuffers, shortIndices.size() * sizeof(GLushort));
+    } else {
+        indexType = GL_UNSIGNED_INT;
+
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, totalIndices * sizeof(GLuint), nullptr, GL_STATIC_DRAW);
+        EBO.track(GpuMemoryCategory::IndexBuffers, totalIndices * sizeof(GLuint));
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(GLuint), indices.data());
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), lodChain.indices.size() * sizeof(GLuint), lodChain.indices.data());
+    }
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (packedLayout) {
+        // Normalized attributes are decoded to [-1, 1] (or [0, 1]), the shader dequantizes them
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
 
-    // Store indice data into the currently bounded EBO
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+
+        glEnableVertexAttribArray(2);
+        if (quantization.halfTexCoords) {
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoords));
+        } else {
+            glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoords));
+        }
+
+        glBindVertexArray(0); // Unbind VAO
+        return;
+    }
 
     // Set vertex attributes pointers which tells OpenGL how it should interpret vertex data
     glEnableVertexAttribArray(0);
@@ -57,40 +119,99 @@ void Mesh::setupMesh() {
     glBindVertexArray(0); // Unbind VAO
 }
 
-void Mesh::draw(ShaderProgram& shaderProgram) {
+size_t Mesh::bindMaterial(ShaderProgram& shaderProgram, std::vector<GLuint>& boundTextures) const {
     GLuint diffuseNr = 0;
     GLuint specularNr = 0;
+    size_t stateChanges = 0;
 
-    for (GLuint i = 0; i < textures.size(); i++) {
+    if (boundTextures.size() < textures.size()) {
+        boundTextures.resize(textures.size(), 0);
+    }
 
-        // Shift to next texture unit macro
-        glActiveTexture(GL_TEXTURE0 + i);
-        std::string number;
-        std::string name = textures[i].type;
+    for (GLuint i = 0; i < textures.size(); i++) {
+        const std::string& name = textures[i].type;
 
+        // Each sampler reads the texture unit matching its position in the mesh's texture list
         if (name == "texture_diffuse") {
-            shaderProgram.setUniform("material.texture_diffuse[" + number + "]", i);
-            number = std::to_string(diffuseNr++);
+            shaderProgram.setUniform(uniformId("material.texture_diffuse[", diffuseNr++, "]"), i);
+            stateChanges++;
         } else if (name == "texture_specular") {
-            shaderProgram.setUniform("material.texture_specular[" + number + "]", i);
-            number = std::to_string(specularNr++);
+            shaderProgram.setUniform(uniformId("material.texture_specular[", specularNr++, "]"), i);
+            stateChanges++;
         }
 
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        if (boundTextures[i] != textures[i].id) {
+            // Shift to next texture unit macro
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            boundTextures[i] = textures[i].id;
+            stateChanges++;
+        }
     }
 
-    shaderProgram.setUniform("material.diffuse_count", diffuseNr);
-    shaderProgram.setUniform("material.specular_count", specularNr);
-    shaderProgram.setUniform("shininess", shininess);
-    
-    // draw mesh
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    shaderProgram.setUniform("material.diffuse_count"_uniform, diffuseNr);
+    shaderProgram.setUniform("material.specular_count"_uniform, specularNr);
+    shaderProgram.setUniform("shininess"_uniform, shininess);
 
-    // reset to default texture
-    glActiveTexture(GL_TEXTURE0);
+    return stateChanges + 3;
 }
 
+void Mesh::drawElements(GLsizei instanceCount, bool instancedDraw) const {
+    const MeshLod& lod = lods[currentLod];
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    void* offset = (void*)(lod.indexOffset * indexSize);
+
+    if (instanceCount == 0) {
+        glDrawElements(GL_TRIANGLES, lod.indexCount, indexType, offset);
+    } else if (instancedDraw) {
+        glDrawElementsInstanced(GL_TRIANGLES, lod.indexCount, indexType, offset, instanceCount);
+    } else {
+        for (GLsizei i = 0; i < instanceCount; i++) {
+            glDrawElementsInstancedBaseInstance(GL_TRIANGLES, lod.indexCount, indexType, offset, 1, i);
+        }
+    }
+}
+
+void Mesh::setInstanceBuffer(GLuint buffer) {
+    glBindVertexArray(VAO.get());
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    // A mat4 attribute takes one location per column
+    for (GLuint column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+
+    glBindVertexArray(0);
+}
 
+void Mesh::selectLod(float pixelsPerUnit, float pixelError) {
+    if (pixelError <= 0.0f) {
+        currentLod = 0;
+        return;
+    }
+
+    // Coarser only once the next level is clearly under the threshold
+    while (currentLod + 1 < lods.size() && lods[currentLod + 1].error * pixelsPerUnit < pixelError * (1.0f - LOD_HYSTERESIS)) {
+        currentLod++;
+    }
 
+    // Finer as soon as the current level is clearly over it
+    while (currentLod > 0 && lods[currentLod].error * pixelsPerUnit > pixelError * (1.0f + LOD_HYSTERESIS)) {
+        currentLod--;
+    }
+}
+
+void Mesh::setBounds(const glm::vec3& newMinBounds, const glm::vec3& newMaxBounds) {
+    minBounds = newMinBounds;
+    maxBounds = newMaxBounds;
+    boundingCenter = (minBounds + maxBounds) * 0.5f;
+    boundingRadius = glm::length(maxBounds - minBounds) * 0.5f;
+}
+
+void Mesh::releaseGeometry() {
+    // Swap with empty vectors, clear() alone keeps the capacity allocated
+    std::vector<Vertex>().swap(vertices);
+    std::vector<GLuint>().swap(indices);
+}
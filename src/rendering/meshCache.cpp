@@ -0,0 +1,345 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+
+#include "rendering/meshCache.hpp"
+#include "rendering/model.hpp"
+#include "utils/mappedFile.hpp"
+#include "utils/hash.hpp"
+#include "config.h"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+bool MeshCache::read(const std::string& modelPath, ModelData& data) {
+    std::string cachePath = getCachePath(modelPath, data);
+
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath, error)) return false;
+
+    MappedFile cache(cachePath);
+    if (!cache.isValid() || cache.getSize() < sizeof(MeshCacheHeader)) return false;
+
+    MeshCacheHeader header;
+    std::memcpy(&header, cache.getData(), sizeof(MeshCacheHeader));
+
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION) return false;
+    if (header.importFlags != Model::getImportFlags(data.profile)) return false;
+    if ((header.meshOptimized != 0) != data.meshOptimized) return false;
+    if ((header.indicesSplit != 0) != data.indicesSplit) return false;
+    if ((header.lodsGenerated != 0) != data.lodsGenerated) return false;
+
+    // Check the source file is still the one the cache was built from
+    if (!isUnchanged(modelPath, header.sourceSize, header.sourceModifiedTime, header.sourceHash)) return false;
+
+    const unsigned char* cursor = cache.getData() + sizeof(MeshCacheHeader);
+    const unsigned char* end = cache.getData() + cache.getSize();
+
+    // Materials and shininess come from the material library, check it did not change either
+    size_t paddedPathLength = (header.materialPathLength + 3) & ~size_t(3);
+    if (size_t(end - cursor) < paddedPathLength) return false;
+
+    if (header.materialPathLength > 0) {
+        std::string materialPath(reinterpret_cast<const char*>(cursor), header.materialPathLength);
+        std::string materialFile = (std::filesystem::path(modelPath).parent_path() / materialPath).string();
+        if (!isUnchanged(materialFile, header.materialSize, header.materialModifiedTime, header.materialHash)) return false;
+    }
+    cursor += paddedPathLength;
+
+    // A damaged count must not drive the reservation
+    if (header.meshCount > size_t(end - cursor) / sizeof(MeshCacheMeshHeader)) return false;
+
+    data.meshes.clear();
+    data.meshes.reserve(header.meshCount);
+
+    for (uint32_t m = 0; m < header.meshCount; m++) {
+        if (end - cursor < (ptrdiff_t) sizeof(MeshCacheMeshHeader)) return false;
+
+        MeshCacheMeshHeader meshHeader;
+        std::memcpy(&meshHeader, cursor, sizeof(MeshCacheMeshHeader));
+        cursor += sizeof(MeshCacheMeshHeader);
+
+        MeshData mesh;
+        mesh.shininess = meshHeader.shininess;
+        mesh.minBounds = glm::vec3(meshHeader.minBounds[0], meshHeader.minBounds[1], meshHeader.minBounds[2]);
+        mesh.maxBounds = glm::vec3(meshHeader.maxBounds[0], meshHeader.maxBounds[1], meshHeader.maxBounds[2]);
+
+        // Read material bindings
+        for (uint32_t t = 0; t < meshHeader.textureCount; t++) {
+            uint32_t lengths[2];
+            if (end - cursor < (ptrdiff_t) sizeof(lengths)) return false;
+            std::memcpy(lengths, cursor, sizeof(lengths));
+            cursor += sizeof(lengths);
+
+            size_t paddedLength = (lengths[0] + lengths[1] + 3) & ~size_t(3);
+            if (end - cursor < (ptrdiff_t) paddedLength) return false;
+
+            Texture texture;
+            texture.id = 0;
+            texture.type.assign(reinterpret_cast<const char*>(cursor), lengths[0]);
+            texture.path.assign(reinterpret_cast<const char*>(cursor) + lengths[0], lengths[1]);
+            mesh.textures.push_back(texture);
+
+            cursor += paddedLength;
+        }
+
+        // Copy the geometry out of the mapping, the staged upload, BVH and packing need it in memory
+        size_t vertexBytes = size_t(meshHeader.vertexCount) * sizeof(Vertex);
+        size_t indexBytes = size_t(meshHeader.indexCount) * sizeof(GLuint);
+        if (size_t(end - cursor) < vertexBytes + indexBytes) return false;
+
+        const Vertex* vertices = reinterpret_cast<const Vertex*>(cursor);
+        mesh.vertices.assign(vertices, vertices + meshHeader.vertexCount);
+        cursor += vertexBytes;
+
+        // Indices past the vertices would be read by the BVH and the optimizer, reject the entry
+        const GLuint* indices = reinterpret_cast<const GLuint*>(cursor);
+        mesh.indices.resize(meshHeader.indexCount);
+        for (uint32_t i = 0; i < meshHeader.indexCount; i++) {
+            if (indices[i] >= meshHeader.vertexCount) return false;
+            mesh.indices[i] = indices[i];
+        }
+        cursor += indexBytes;
+
+        // Read the levels of detail
+        size_t lodBytes = size_t(meshHeader.lodCount) * sizeof(MeshCacheLod);
+        size_t lodIndexBytes = size_t(meshHeader.lodIndexCount) * sizeof(GLuint);
+        if (size_t(end - cursor) < lodBytes + lodIndexBytes) return false;
+
+        for (uint32_t l = 0; l < meshHeader.lodCount; l++) {
+            MeshCacheLod lod;
+            std::memcpy(&lod, cursor, sizeof(MeshCacheLod));
+            cursor += sizeof(MeshCacheLod);
+
+            // Every level must lie within the record's LOD indices
+            if (size_t(lod.indexOffset) + lod.indexCount > meshHeader.lodIndexCount) return false;
+            mesh.lodChain.levels.push_back(MeshLod{ lod.indexOffset, GLsizei(lod.indexCount), lod.error });
+        }
+
+        const GLuint* lodIndices = reinterpret_cast<const GLuint*>(cursor);
+        mesh.lodChain.indices.resize(meshHeader.lodIndexCount);
+        for (uint32_t i = 0; i < meshHeader.lodIndexCount; i++) {
+            if (lodIndices[i] >= meshHeader.vertexCount) return false;
+            mesh.lodChain.indices[i] = lodIndices[i];
+        }
+        cursor += lodIndexBytes;
+
+        data.meshes.push_back(std::move(mesh));
+    }
+
+    data.needFlip = header.needFlip != 0;
+    data.minBounds = glm::vec3(header.minBounds[0], header.minBounds[1], header.minBounds[2]);
+    data.maxBounds = glm::vec3(header.maxBounds[0], header.maxBounds[1], header.maxBounds[2]);
+    data.sourceStats.meshCount = header.sourceMeshCount;
+    data.sourceStats.vertexCount = header.sourceVertexCount;
+    data.sourceStats.indexCount = header.sourceIndexCount;
+    data.sourceStats.transformedVertices = header.sourceTransformedVertices;
+
+    return true;
+}
+
+bool MeshCache::write(const std::string& modelPath, const ModelData& data) {
+    std::string cachePath = getCachePath(modelPath, data);
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+    if (error) {
+        std::cerr << "MeshCache: failed to create cache directory for " << cachePath << std::endl;
+        return false;
+    }
+
+    MeshCacheHeader header = {};
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = MESH_CACHE_VERSION;
+    header.sourceSize = std::filesystem::file_size(modelPath, error);
+    if (error) return false;
+    header.sourceModifiedTime = std::filesystem::last_write_time(modelPath, error).time_since_epoch().count();
+    if (error) return false;
+    if (!hashFile(modelPath, header.sourceHash)) return false;
+
+    // A library that cannot be read is not recorded, Assimp imports the model without it
+    std::string materialPath = findMaterialLibrary(modelPath);
+    if (!materialPath.empty()) {
+        std::string materialFile = (std::filesystem::path(modelPath).parent_path() / materialPath).string();
+        header.materialSize = std::filesystem::file_size(materialFile, error);
+        if (!error) header.materialModifiedTime = std::filesystem::last_write_time(materialFile, error).time_since_epoch().count();
+
+        if (!error && hashFile(materialFile, header.materialHash)) {
+            header.materialPathLength = materialPath.size();
+        } else {
+            materialPath.clear();
+            header.materialSize = 0;
+            header.materialModifiedTime = 0;
+            header.materialHash = 0;
+        }
+    }
+
+    header.meshCount = data.meshes.size();
+    header.needFlip = data.needFlip ? 1 : 0;
+    for (int i = 0; i < 3; i++) {
+        header.minBounds[i] = data.minBounds[i];
+        header.maxBounds[i] = data.maxBounds[i];
+    }
+    header.importFlags = Model::getImportFlags(data.profile);
+    header.sourceMeshCount = data.sourceStats.meshCount;
+    header.sourceVertexCount = data.sourceStats.vertexCount;
+    header.sourceIndexCount = data.sourceStats.indexCount;
+    header.sourceTransformedVertices = data.sourceStats.transformedVertices;
+    header.meshOptimized = data.meshOptimized ? 1 : 0;
+    header.indicesSplit = data.indicesSplit ? 1 : 0;
+    header.lodsGenerated = data.lodsGenerated ? 1 : 0;
+
+    // Write to a temporary file first so a partially written cache is never read
+    std::string tempPath = cachePath + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "MeshCache: failed to open " << tempPath << " for writing" << std::endl;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const char padding[4] = {0, 0, 0, 0};
+    out.write(materialPath.data(), materialPath.size());
+    out.write(padding, ((materialPath.size() + 3) & ~size_t(3)) - materialPath.size());
+
+    for (const MeshData& mesh : data.meshes) {
+        MeshCacheMeshHeader meshHeader = {};
+        meshHeader.vertexCount = mesh.vertices.size();
+        meshHeader.indexCount = mesh.indices.size();
+        meshHeader.textureCount = mesh.textures.size();
+        meshHeader.shininess = mesh.shininess;
+        meshHeader.lodCount = mesh.lodChain.levels.size();
+        meshHeader.lodIndexCount = mesh.lodChain.indices.size();
+        for (int i = 0; i < 3; i++) {
+            meshHeader.minBounds[i] = mesh.minBounds[i];
+            meshHeader.maxBounds[i] = mesh.maxBounds[i];
+        }
+        out.write(reinterpret_cast<const char*>(&meshHeader), sizeof(meshHeader));
+
+        for (const Texture& texture : mesh.textures) {
+            uint32_t lengths[2] = { (uint32_t) texture.type.size(), (uint32_t) texture.path.size() };
+            out.write(reinterpret_cast<const char*>(lengths), sizeof(lengths));
+            out.write(texture.type.data(), lengths[0]);
+            out.write(texture.path.data(), lengths[1]);
+
+            size_t length = lengths[0] + lengths[1];
+            out.write(padding, ((length + 3) & ~size_t(3)) - length);
+        }
+
+        out.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+        out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(GLuint));
+
+        for (const MeshLod& level : mesh.lodChain.levels) {
+            MeshCacheLod lod = {};
+            lod.indexOffset = level.indexOffset;
+            lod.indexCount = level.indexCount;
+            lod.error = level.error;
+            out.write(reinterpret_cast<const char*>(&lod), sizeof(lod));
+        }
+        out.write(reinterpret_cast<const char*>(mesh.lodChain.indices.data()), mesh.lodChain.indices.size() * sizeof(GLuint));
+    }
+
+    out.close();
+    if (!out) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    return !error;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+std::string MeshCache::getCachePath(const std::string& modelPath, const ModelData& data) {
+    // Same named models in different directories must not share a cache file
+    std::error_code error;
+    std::filesystem::path sourcePath = std::filesystem::weakly_canonical(modelPath, error);
+    if (error) sourcePath = std::filesystem::absolute(modelPath, error);
+
+    char pathHash[17];
+    std::snprintf(pathHash, sizeof(pathHash), "%016llx", (unsigned long long) hashString(sourcePath.generic_string()));
+
+    std::string name = std::filesystem::path(modelPath).stem().string();
+    name += std::string(".") + pathHash;
+    name += std::string(".") + ImportProfileSelection::names[(int) data.profile];
+
+    if (data.meshOptimized) {
+        name += ".opt";
+    }
+
+    if (data.indicesSplit) {
+        name += ".split";
+    }
+
+    if (data.lodsGenerated) {
+        name += ".lod";
+    }
+
+    return std::string(CACHE_PATH) + "models/" + name + MESH_CACHE_EXTENSION;
+}
+
+bool MeshCache::hashFile(const std::string& path, uint64_t& hash) {
+    MappedFile file(path);
+    if (!file.isValid()) return false;
+
+    hash = hashBytes(file.getData(), file.getSize());
+    return true;
+}
+
+bool MeshCache::isUnchanged(const std::string& path, uint64_t size, int64_t modifiedTime, uint64_t hash) {
+    std::error_code error;
+    uint64_t currentSize = std::filesystem::file_size(path, error);
+    if (error) return false;
+    int64_t currentTime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    if (error) return false;
+
+    if (currentSize != size) return false;
+
+    if (currentTime != modifiedTime) {
+        // Time changed but content may not have (eg: fresh checkout), compare hashes
+        uint64_t currentHash;
+        if (!hashFile(path, currentHash) || currentHash != hash) return false;
+    }
+
+    return true;
+}
+
+std::string MeshCache::findMaterialLibrary(const std::string& modelPath) {
+    std::string extension = std::filesystem::path(modelPath).extension().string();
+    if (extension != ".obj" && extension != ".OBJ") return "";
+
+    MappedFile file(modelPath);
+    if (!file.isValid()) return "";
+
+    std::string_view content(reinterpret_cast<const char*>(file.getData()), file.getSize());
+    size_t lineStart = 0;
+    while (lineStart < content.size()) {
+        size_t lineEnd = content.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) lineEnd = content.size();
+        std::string_view line = content.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string_view::npos || line.substr(first, 7) != "mtllib ") continue;
+
+        size_t nameStart = line.find_first_not_of(" \t", first + 7);
+        size_t nameEnd = line.find_last_not_of(" \t\r");
+        if (nameStart == std::string_view::npos || nameEnd < nameStart) return "";
+
+        return std::string(line.substr(nameStart, nameEnd - nameStart + 1));
+    }
+
+    return "";
+}
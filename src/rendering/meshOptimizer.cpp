@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+#include "rendering/meshOptimizer.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+void MeshOptimizer::optimize(MeshData& mesh) {
+    if (mesh.indices.size() < 3) return;
+
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeOverdraw(mesh.indices, mesh.vertices);
+    optimizeVertexFetch(mesh.vertices, mesh.indices);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<GLuint>& indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles using each vertex, stored contiguously per vertex with the live ones first
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (GLuint index : indices) {
+        liveTriangles[index]++;
+    }
+
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        offsets[v + 1] = offsets[v] + liveTriangles[v];
+    }
+
+    std::vector<size_t> adjacency(indices.size());
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            adjacency[fill[indices[t * 3 + k]]++] = t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        scores[v] = vertexScore(-1, liveTriangles[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    size_t best = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+        if (triangleScores[t] > triangleScores[best]) best = t;
+    }
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+
+    std::vector<GLuint> cache;
+    std::vector<GLuint> nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    size_t scan = 0; // next candidate when no cached vertex has live triangles left
+
+    for (size_t i = 0; i < triangleCount; i++) {
+        if (best == SIZE_MAX) {
+            while (emitted[scan]) scan++;
+            best = scan;
+        }
+
+        emitted[best] = 1;
+        const GLuint triangle[3] = { indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2] };
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // Move the emitted triangle past the live range of each of its vertices
+        for (GLuint v : triangle) {
+            auto begin = adjacency.begin() + offsets[v];
+            auto end = begin + liveTriangles[v];
+            auto it = std::find(begin, end, best);
+
+            if (it != end) {
+                std::iter_swap(it, end - 1);
+                liveTriangles[v]--;
+            }
+        }
+
+        // The emitted vertices go to the front of the simulated LRU cache
+        nextCache.clear();
+        for (GLuint v : triangle) {
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+                nextCache.push_back(v);
+            }
+        }
+        for (GLuint v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // Rescore every vertex that moved, including those pushed out of the cache
+        for (size_t p = 0; p < nextCache.size(); p++) {
+            GLuint v = nextCache[p];
+            cachePosition[v] = p < FORSYTH_CACHE_SIZE ? (int) p : -1;
+            scores[v] = vertexScore(cachePosition[v], liveTriangles[v]);
+        }
+
+        if (nextCache.size() > FORSYTH_CACHE_SIZE) {
+            nextCache.resize(FORSYTH_CACHE_SIZE);
+        }
+        cache.swap(nextCache);
+
+        // Next triangle is the best one touching the cache
+        best = SIZE_MAX;
+        float bestScore = -1.0f;
+
+        for (GLuint v : cache) {
+            for (size_t a = offsets[v]; a < offsets[v] + liveTriangles[v]; a++) {
+                size_t t = adjacency[a];
+                float score = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+                triangleScores[t] = score;
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+        }
+    }
+
+    indices = std::move(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(std::vector<GLuint>& indices, const std::vector<Vertex>& vertices, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    std::vector<size_t> clusters = buildClusters(indices, vertices.size(), threshold);
+    if (clusters.size() < 2) return;
+
+    glm::vec3 meshCentroid(0.0f);
+    for (GLuint index : indices) {
+        meshCentroid += vertices[index].position;
+    }
+    meshCentroid /= float(indices.size());
+
+    // Clusters facing away from the mesh center are likely to occlude the others, draw them first
+    std::vector<float> sortKeys(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++) {
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+
+        for (size_t t = clusters[c]; t < end; t++) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+
+            glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(cross);
+
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+
+        float normalLength = glm::length(normal);
+        if (area <= 0.0f || normalLength <= 0.0f) {
+            sortKeys[c] = 0.0f;
+            continue;
+        }
+
+        sortKeys[c] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+    }
+
+    std::vector<size_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+
+    for (size_t c : order) {
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+    }
+
+    indices = std::move(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<GLuint>& indices) {
+    const GLuint unused = ~GLuint(0);
+    std::vector<GLuint> remap(vertices.size(), unused);
+
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (GLuint& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = (GLuint) result.size();
+            result.push_back(vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    vertices = std::move(result);
+}
+
+size_t MeshOptimizer::simulateVertexCache(const std::vector<GLuint>& indices, size_t vertexCount, unsigned int cacheSize) {
+    // A vertex is cached while fewer than cacheSize misses happened since it was last loaded
+    std::vector<size_t> timestamps(vertexCount, 0);
+    size_t timestamp = cacheSize + 1;
+    size_t misses = 0;
+
+    for (GLuint index : indices) {
+        if (timestamp - timestamps[index] > cacheSize) {
+            timestamps[index] = timestamp++;
+            misses++;
+        }
+    }
+
+    return misses;
+}
+
+std::vector<MeshData> MeshOptimizer::splitMesh(const MeshData& mesh, size_t maxVertices) {
+    const GLuint unused = ~GLuint(0);
+    std::vector<GLuint> remap(mesh.vertices.size(), unused);
+    std::vector<GLuint> remapped; // vertices of the current part, to reset the remap on a new part
+
+    std::vector<MeshData> parts;
+    auto startPart = [&]() {
+        for (GLuint v : remapped) {
+            remap[v] = unused;
+        }
+        remapped.clear();
+
+        MeshData& part = parts.emplace_back();
+        part.textures = mesh.textures;
+        part.shininess = mesh.shininess;
+    };
+
+    startPart();
+
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        const GLuint triangle[3] = { mesh.indices[t], mesh.indices[t + 1], mesh.indices[t + 2] };
+
+        // Distinct vertices the triangle would add to the current part
+        size_t added = 0;
+        for (int k = 0; k < 3; k++) {
+            bool repeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+            if (remap[triangle[k]] == unused && !repeated) added++;
+        }
+
+        if (parts.back().vertices.size() + added > maxVertices) {
+            startPart();
+        }
+
+        MeshData& part = parts.back();
+        for (GLuint v : triangle) {
+            if (remap[v] == unused) {
+                remap[v] = (GLuint) part.vertices.size();
+                part.vertices.push_back(mesh.vertices[v]);
+                remapped.push_back(v);
+
+                part.minBounds = glm::min(part.minBounds, mesh.vertices[v].position);
+                part.maxBounds = glm::max(part.maxBounds, mesh.vertices[v].position);
+            }
+
+            part.indices.push_back(remap[v]);
+        }
+    }
+
+    return parts;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+float MeshOptimizer::vertexScore(int cachePosition, unsigned int liveTriangles) {
+    // No triangle left to emit
+    if (liveTriangles == 0) return -1.0f;
+
+    float score = 0.0f;
+
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // Vertices of the last triangle get a fixed score so the same triangle is not favored again
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        } else {
+            float scaler = 1.0f / float(FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - float(cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Favor vertices with few triangles left so isolated triangles are not left behind
+    score += FORSYTH_VALENCE_BOOST_SCALE * std::pow(float(liveTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+
+    return score;
+}
+
+std::vector<size_t> MeshOptimizer::buildClusters(const std::vector<GLuint>& indices, size_t vertexCount, float threshold) {
+    size_t triangleCount = indices.size() / 3;
+    const unsigned int cacheSize = VERTEX_CACHE_SIZE;
+
+    std::vector<size_t> timestamps(vertexCount, 0);
+    size_t timestamp = cacheSize + 1;
+
+    auto misses = [&](size_t t) {
+        unsigned int count = 0;
+        for (int k = 0; k < 3; k++) {
+            GLuint index = indices[t * 3 + k];
+            if (timestamp - timestamps[index] > cacheSize) {
+                timestamps[index] = timestamp++;
+                count++;
+            }
+        }
+        return count;
+    };
+    auto resetCache = [&]() { timestamp += cacheSize + 1; };
+
+    // Hard boundaries where a triangle shares no vertex with the cache, usually a new patch
+    std::vector<size_t> hard;
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (misses(t) == 3 || t == 0) hard.push_back(t);
+    }
+
+    // Soft boundaries split each patch wherever the running ACMR is already good enough
+    std::vector<size_t> clusters;
+    for (size_t h = 0; h < hard.size(); h++) {
+        size_t start = hard[h];
+        size_t end = h + 1 < hard.size() ? hard[h + 1] : triangleCount;
+
+        resetCache();
+        size_t clusterMisses = 0;
+        for (size_t t = start; t < end; t++) {
+            clusterMisses += misses(t);
+        }
+        float clusterThreshold = threshold * float(clusterMisses) / float(end - start);
+
+        clusters.push_back(start);
+        resetCache();
+
+        size_t runningMisses = 0;
+        size_t runningTriangles = 0;
+
+        for (size_t t = start; t < end; t++) {
+            runningMisses += misses(t);
+            runningTriangles++;
+
+            if (float(runningMisses) / float(runningTriangles) <= clusterThreshold) {
+                clusters.push_back(t + 1);
+                resetCache();
+                runningMisses = 0;
+                runningTriangles = 0;
+            }
+        }
+
+        // The last split leaves a small poor cluster behind, merge it with the previous one
+        if (clusters.back() != start) clusters.pop_back();
+    }
+
+    return clusters;
+}
@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "rendering/meshSimplifier.hpp"
+
+
+/**
+ * @brief Builds the key of an undirected edge
+ */
+static uint64_t edgeKey(GLuint a, GLuint b) {
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+std::vector<GLuint> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                             size_t targetIndexCount, float maxError, float& resultError) {
+    resultError = 0.0f;
+
+    size_t vertexCount = vertices.size();
+    std::vector<GLuint> result(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+    if (result.size() <= targetIndexCount) return result;
+
+    // Identical vertices become one, vertices sharing only their position are wedges of one point
+    std::vector<GLuint> unique = buildRemap(vertices, sizeof(Vertex));
+    std::vector<GLuint> position = buildRemap(vertices, sizeof(glm::vec3));
+
+    for (GLuint& index : result) {
+        index = unique[index];
+    }
+
+    // Points with several wedges are on a seam, points on an edge shared by more than two triangles are non-manifold
+    std::vector<char> locked(vertexCount, 0);
+    std::vector<GLuint> firstWedge(vertexCount, ~GLuint(0));
+    for (GLuint index : result) {
+        GLuint p = position[index];
+
+        if (firstWedge[p] == ~GLuint(0)) {
+            firstWedge[p] = index;
+        } else if (firstWedge[p] != index) {
+            locked[p] = 1;
+        }
+    }
+
+    std::vector<uint64_t> edges = collectEdges(result, position);
+    std::vector<uint64_t> borderEdges;
+
+    for (size_t e = 0; e < edges.size();) {
+        size_t run = e;
+        while (run < edges.size() && edges[run] == edges[e]) run++;
+
+        if (run - e == 1) {
+            borderEdges.push_back(edges[e]);
+        } else if (run - e > 2) {
+            locked[edges[e] >> 32] = 1;
+            locked[edges[e] & 0xFFFFFFFFu] = 1;
+        }
+
+        e = run;
+    }
+
+    // Area weighted triangle planes, plus planes perpendicular to border edges so borders keep their shape
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < result.size(); t += 3) {
+        const glm::vec3& p0 = vertices[result[t]].position;
+        const glm::vec3& p1 = vertices[result[t + 1]].position;
+        const glm::vec3& p2 = vertices[result[t + 2]].position;
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f) continue;
+
+        normal /= length;
+        float area = length * 0.5f;
+
+        for (int k = 0; k < 3; k++) {
+            quadrics[position[result[t + k]]].addPlane(normal, -glm::dot(normal, p0), area);
+        }
+
+        for (int k = 0; k < 3; k++) {
+            GLuint a = position[result[t + k]];
+            GLuint b = position[result[t + (k + 1) % 3]];
+            if (!std::binary_search(borderEdges.begin(), borderEdges.end(), edgeKey(a, b))) continue;
+
+            const glm::vec3& pa = vertices[a].position;
+            const glm::vec3& pb = vertices[b].position;
+            float edgeLength = glm::length(pb - pa);
+            if (edgeLength <= 0.0f) continue;
+
+            glm::vec3 borderNormal = glm::normalize(glm::cross(pb - pa, normal));
+            float weight = edgeLength * edgeLength * LOD_BORDER_WEIGHT;
+
+            quadrics[a].addPlane(borderNormal, -glm::dot(borderNormal, pa), weight);
+            quadrics[b].addPlane(borderNormal, -glm::dot(borderNormal, pa), weight);
+        }
+    }
+
+    std::vector<GLuint> remap(vertexCount);
+    std::vector<char> touched(vertexCount, 0);
+    std::vector<char> border(vertexCount, 0);
+    std::vector<size_t> offsets(vertexCount + 1);
+    std::vector<size_t> adjacency;
+    std::vector<uint64_t> candidates;
+    std::vector<Collapse> collapses;
+
+    while (result.size() > targetIndexCount) {
+        // Borders change as triangles go away, find them again on every pass
+        edges = collectEdges(result, position);
+        borderEdges.clear();
+        std::fill(border.begin(), border.end(), 0);
+
+        for (size_t e = 0; e < edges.size();) {
+            size_t run = e;
+            while (run < edges.size() && edges[run] == edges[e]) run++;
+
+            if (run - e == 1) {
+                borderEdges.push_back(edges[e]);
+                border[edges[e] >> 32] = 1;
+                border[edges[e] & 0xFFFFFFFFu] = 1;
+            }
+
+            e = run;
+        }
+
+        // Triangles using each vertex
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (GLuint index : result) {
+            offsets[index + 1]++;
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        adjacency.resize(result.size());
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < result.size(); i++) {
+            adjacency[fill[result[i]]++] = i / 3;
+        }
+
+        candidates.clear();
+        for (size_t t = 0; t < result.size(); t += 3) {
+            for (int k = 0; k < 3; k++) {
+                candidates.push_back(edgeKey(result[t + k], result[t + (k + 1) % 3]));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        // Cheapest allowed direction of every edge
+        collapses.clear();
+        for (uint64_t key : candidates) {
+            GLuint a = GLuint(key >> 32);
+            GLuint b = GLuint(key & 0xFFFFFFFFu);
+            GLuint pa = position[a];
+            GLuint pb = position[b];
+
+            bool borderEdge = std::binary_search(borderEdges.begin(), borderEdges.end(), edgeKey(pa, pb));
+            auto allowed = [&](GLuint from, GLuint to) {
+                if (locked[from]) return false;
+                // Border vertices only slide along their border
+                return !border[from] || (border[to] && borderEdge);
+            };
+
+            Collapse best = { 0, 0, INFINITY };
+            if (allowed(pa, pb)) {
+                best = { a, b, quadrics[pa].error(vertices[b].position) };
+            }
+            if (allowed(pb, pa)) {
+                float error = quadrics[pb].error(vertices[a].position);
+                if (error < best.error) best = { b, a, error };
+            }
+
+            if (best.error < INFINITY) collapses.push_back(best);
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.error < y.error;
+        });
+
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t trianglesRemoved = 0;
+        size_t collapseCount = 0;
+
+        for (const Collapse& collapse : collapses) {
+            if (collapse.error > maxError || trianglesRemoved >= trianglesToRemove) break;
+
+            // Each vertex takes part in at most one collapse per pass, so costs and flip checks stay valid
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+            if (hasTriangleFlips(vertices, result, offsets, adjacency, position, remap, collapse.from, collapse.to)) continue;
+
+            remap[collapse.from] = collapse.to;
+            touched[collapse.from] = 1;
+            touched[collapse.to] = 1;
+
+            quadrics[position[collapse.to]].add(quadrics[position[collapse.from]]);
+            resultError = std::max(resultError, collapse.error);
+
+            trianglesRemoved += border[position[collapse.from]] ? 1 : 2;
+            collapseCount++;
+        }
+
+        if (collapseCount == 0) break;
+
+        // Apply the collapses and drop the triangles that became degenerate
+        size_t write = 0;
+        for (size_t t = 0; t < result.size(); t += 3) {
+            GLuint a = remap[result[t]];
+            GLuint b = remap[result[t + 1]];
+            GLuint c = remap[result[t + 2]];
+
+            if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c]) continue;
+
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    return result;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+void MeshSimplifier::Quadric::addPlane(const glm::vec3& normal, float distance, float planeWeight) {
+    double w = planeWeight;
+    double x = normal.x, y = normal.y, z = normal.z, d = distance;
+
+    a00 += w * x * x; a11 += w * y * y; a22 += w * z * z;
+    a01 += w * x * y; a02 += w * x * z; a12 += w * y * z;
+    b0 += w * x * d; b1 += w * y * d; b2 += w * z * d;
+    c += w * d * d;
+    weight += w;
+}
+
+void MeshSimplifier::Quadric::add(const Quadric& other) {
+    a00 += other.a00; a11 += other.a11; a22 += other.a22;
+    a01 += other.a01; a02 += other.a02; a12 += other.a12;
+    b0 += other.b0; b1 += other.b1; b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+}
+
+float MeshSimplifier::Quadric::error(const glm::vec3& position) const {
+    if (weight <= 0.0) return 0.0f;
+
+    double x = position.x, y = position.y, z = position.z;
+    double value = a00 * x * x + a11 * y * y + a22 * z * z +
+                   2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2.0 * (b0 * x + b1 * y + b2 * z) + c;
+
+    return (float) std::sqrt(std::max(value, 0.0) / weight);
+}
+
+std::vector<GLuint> MeshSimplifier::buildRemap(const std::vector<Vertex>& vertices, size_t bytes) {
+    std::vector<GLuint> order(vertices.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    auto less = [&](GLuint a, GLuint b) {
+        int comparison = std::memcmp(&vertices[a], &vertices[b], bytes);
+        return comparison < 0 || (comparison == 0 && a < b);
+    };
+    std::sort(order.begin(), order.end(), less);
+
+    // Equal vertices are adjacent once sorted, the lowest index of each run represents it
+    std::vector<GLuint> remap(vertices.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        bool same = i > 0 && std::memcmp(&vertices[order[i]], &vertices[order[i - 1]], bytes) == 0;
+        remap[order[i]] = same ? remap[order[i - 1]] : order[i];
+    }
+
+    return remap;
+}
+
+std::vector<uint64_t> MeshSimplifier::collectEdges(const std::vector<GLuint>& indices, const std::vector<GLuint>& position) {
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int k = 0; k < 3; k++) {
+            edges.push_back(edgeKey(position[indices[t + k]], position[indices[t + (k + 1) % 3]]));
+        }
+    }
+
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+bool MeshSimplifier::hasTriangleFlips(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+                                      const std::vector<size_t>& offsets, const std::vector<size_t>& adjacency,
+                                      const std::vector<GLuint>& position, const std::vector<GLuint>& remap, GLuint from, GLuint to) {
+    const glm::vec3& target = vertices[to].position;
+
+    for (size_t a = offsets[from]; a < offsets[from + 1]; a++) {
+        size_t t = adjacency[a] * 3;
+        GLuint corners[3] = { remap[indices[t]], remap[indices[t + 1]], remap[indices[t + 2]] };
+
+        // Triangles along the collapsed edge disappear
+        GLuint targetPosition = position[to];
+        if (position[corners[0]] == targetPosition || position[corners[1]] == targetPosition || position[corners[2]] == targetPosition) continue;
+
+        glm::vec3 before[3];
+        glm::vec3 after[3];
+        for (int k = 0; k < 3; k++) {
+            before[k] = vertices[corners[k]].position;
+            after[k] = corners[k] == from ? target : before[k];
+        }
+
+        glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+        glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+        if (glm::dot(normalBefore, normalAfter) <= 0.0f) return true;
+    }
+
+    return false;
+}
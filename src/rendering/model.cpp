@@ -1,14 +1,48 @@
 #include <iostream>
-#include <stb_include/stb_image.h>
-#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <assimp/config.h>
+#include <assimp/ProgressHandler.hpp>
 
 #include "rendering/model.hpp"
+#include "rendering/meshCache.hpp"
+#include "rendering/meshOptimizer.hpp"
+#include "rendering/meshSimplifier.hpp"
+#include "rendering/frustum.hpp"
+#include "rendering/textureLoader.hpp"
+#include "rendering/textureCache.hpp"
+#include "utils/threadPool.hpp"
 #include "utils/constants.hpp"
 
 
-Model::Model(const std::string &path) {
+/**
+ * @brief Forwards Assimp's import progress to a model's load progress
+ */
+class ImportProgressHandler : public Assimp::ProgressHandler {
+private:
+    std::atomic<float>* progress;   ///< Progress to update, may be null
+
+public:
+    ImportProgressHandler(std::atomic<float>* progress) : progress(progress) {}
+
+    bool Update(float percentage) override {
+        if (progress && percentage >= 0.0f) {
+            progress->store(percentage * LOAD_PROGRESS_IMPORTED);
+        }
+        return true; // never cancel the import
+    }
+};
+
+
+Model::Model(const std::string &path, const ModelSettings& settings) : Model(path, settings, nullptr) {
+    upload();
+}
+
+Model::Model(const std::string &path, const ModelSettings& settings, std::atomic<float>* progress) 
+    : settings(settings), progress(progress) {
     minBounds = glm::vec3(FLT_MAX);
     maxBounds = glm::vec3(-FLT_MAX);
     loadModel(path);
@@ -20,14 +54,27 @@ Model::~Model() {
 }
 
 void Model::cleanup() {
+    meshes.clear();
+    meshVisible.clear();
+    instances.clear();
+    instanceWorlds.clear();
+    instanceScales.clear();
+
+    instanceBuffer.reset();
+
+    // Textures stay resident in the cache for a while in case they are needed again
+    TextureCache& cache = TextureCache::getShared();
 
-    for (const auto& texture: textures_loaded) {
-        glDeleteTextures(1, &texture.id);
+    for (const auto& [path, id] : textures_loaded) {
+        cache.release(id);
     }
 
     textures_loaded.clear();
-    
-    meshes.clear();
+
+    if (nullTexture != 0) {
+        cache.release(nullTexture);
+        nullTexture = 0;
+    }
 }
 
 void Model::calculateModelDimension() {
@@ -36,10 +83,154 @@ void Model::calculateModelDimension() {
     modelRadius = glm::length(modelSize) * 0.5f;
 }
 
-void Model::draw(ShaderProgram &shader) {
+void Model::draw(ShaderProgram &shader, RenderQueue& queue, const glm::mat4& view) {
+    drawnTriangles = 0;
+    drawnMeshes = 0;
+    drawCalls = 0;
+
+    GLsizei instanceCount = (GLsizei) instances.size();
+    glm::mat4 modelView = view * getModelMatrix();
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        if (!meshVisible[i]) continue;
+
+        // The camera looks down -z in view space
+        float depth = -(modelView * glm::vec4(meshes[i]->getBoundingCenter(), 1.0f)).z;
+        queue.submit(shader, *meshes[i], depth, instanceCount, instancedDrawing);
+        drawnTriangles += meshes[i]->getDrawnTriangles() * getInstanceCount();
+        drawnMeshes++;
+        drawCalls += instancedDrawing ? 1 : getInstanceCount();
+    }
+}
+
+void Model::setInstances(const std::vector<glm::mat4>& transforms) {
+    instances = transforms;
+    instanceWorlds.resize(instances.size());
+    instanceScales.resize(instances.size());
+    if (instances.empty()) return;
+
+    if (!instanceBuffer) {
+        instanceBuffer = GlBuffer::create();
+
+        for (const auto& meshPtr : meshes) {
+            meshPtr->setInstanceBuffer(instanceBuffer.get());
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::mat4), instances.data(), GL_DYNAMIC_DRAW);
+    instanceBuffer.track(GpuMemoryCategory::VertexBuffers, instances.size() * sizeof(glm::mat4));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Model::cullMeshes(const glm::vec3& cameraPos, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) {
+    culledMeshes = 0;
+
+    if (!frustumCulling) {
+        std::fill(meshVisible.begin(), meshVisible.end(), 1);
+        return;
+    }
+
+    // Instanced meshes are kept if any of their copies is in view, there is one draw for all of them
+    if (!instances.empty()) {
+        Frustum frustum(projection * view);
+
+        for (size_t k = 0; k < instances.size(); k++) {
+            instanceWorlds[k] = instances[k] * getModelMatrix();
+            instanceScales[k] = getModelScale() * glm::length(glm::vec3(instances[k][0]));
+        }
+
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const Mesh& mesh = *meshes[i];
+            bool visible = false;
+
+            for (size_t k = 0; k < instances.size() && !visible; k++) {
+                glm::vec3 center = glm::vec3(instanceWorlds[k] * glm::vec4(mesh.getBoundingCenter(), 1.0f));
+                visible = frustum.intersectsSphere(center, mesh.getBoundingRadius() * instanceScales[k]);
+            }
+
+            meshVisible[i] = visible;
+            if (!visible) culledMeshes++;
+        }
+
+        return;
+    }
+
+    // Planes in model space, so the mesh bounds are tested as they are
+    const glm::mat4& model = getModelMatrix();
+    Frustum frustum(projection * view * model);
+
+    float scale = getModelScale();
+    float pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const Mesh& mesh = *meshes[i];
+        bool visible = frustum.intersectsSphere(mesh.getBoundingCenter(), mesh.getBoundingRadius()) &&
+                       frustum.intersectsBox(mesh.getMinBounds(), mesh.getMaxBounds());
+
+        // Skip meshes too small on screen to matter, unless the camera is inside their bounding sphere
+        if (visible) {
+            float radius = mesh.getBoundingRadius() * scale;
+            float distance = glm::length(glm::vec3(model * glm::vec4(mesh.getBoundingCenter(), 1.0f)) - cameraPos);
+
+            if (distance > radius && radius * pixelsPerUnit / distance < CULL_MIN_PIXEL_RADIUS) {
+                visible = false;
+            }
+        }
+
+        meshVisible[i] = visible;
+        if (!visible) culledMeshes++;
+    }
+}
+
+void Model::selectLods(const glm::vec3& cameraPos, const glm::mat4& projection, float viewportHeight) {
+    glm::vec3 center = glm::vec3(getModelMatrix() * glm::vec4(modelCenter, 1.0f));
+    float pixelsPerUnit = 0.0f;
+
+    // Every instance shares the level of detail, the one appearing largest on screen decides
+    for (size_t k = 0; k < getInstanceCount(); k++) {
+        glm::vec3 instanceCenter = center;
+        float scale = getModelScale();
+
+        if (!instances.empty()) {
+            instanceCenter = glm::vec3(instances[k] * glm::vec4(center, 1.0f));
+            scale *= glm::length(glm::vec3(instances[k][0]));
+        }
+
+        // Distance to the nearest point of the bounding sphere, the camera may be inside it
+        float distance = std::max(glm::length(instanceCenter - cameraPos) - modelRadius * scale, DEFAULT_NEAR_CLIPPING_PLANE);
+        pixelsPerUnit = std::max(pixelsPerUnit, projection[1][1] * viewportHeight * 0.5f * scale / distance);
+    }
+
     for (const auto& meshPtr : meshes) {
-        meshPtr->draw(shader);
+        meshPtr->selectLod(pixelsPerUnit, lodPixelError);
+    }
+}
+
+RayHit Model::raycast(const glm::vec3& origin, const glm::vec3& direction) const {
+    glm::vec3 worldDirection = glm::normalize(direction);
+    RayHit closest;
+    closest.distance = INFINITY;
+
+    for (size_t k = 0; k < getInstanceCount(); k++) {
+        glm::mat4 world = instances.empty() ? getModelMatrix() : instances[k] * getModelMatrix();
+        glm::mat4 inverseModel = glm::inverse(world);
+
+        // Hit distances along the model space direction match world distances along the unit one
+        glm::vec3 localOrigin = glm::vec3(inverseModel * glm::vec4(origin, 1.0f));
+        glm::vec3 localDirection = glm::vec3(inverseModel * glm::vec4(worldDirection, 0.0f));
+
+        RayHit hit = bvh.intersect(localOrigin, localDirection, closest.distance);
+        if (hit.hit) {
+            hit.position = origin + worldDirection * hit.distance;
+            hit.localPosition = localOrigin + localDirection * hit.distance;
+            hit.instanceIndex = uint32_t(k);
+            closest = hit;
+        }
     }
+
+    if (!closest.hit) return RayHit();
+    return closest;
 }
 
 const glm::vec3 Model::getModelCenter() const {
@@ -51,87 +242,454 @@ const float Model::getModelRadius() const {
 }
 
 void Model::loadModel(const std::string &path) {
-    // Initially load without aiProcess_FlipUVs
-    scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+    auto start = std::chrono::steady_clock::now();
+
+    // Save model directory
+    directory = path.substr(0, path.find_last_of('/'));
+    modelPath = path;
+
+    pendingData.profile = settings.importProfile;
+    pendingData.meshOptimized = settings.meshOptimization;
+    pendingData.indicesSplit = settings.splitIndexBuffers;
+    pendingData.lodsGenerated = settings.generateLods;
+    loadedFromCache = MeshCache::read(path, pendingData);
+
+    if (!loadedFromCache) {
+        if (!importModel(path, pendingData)) return;
+
+        if (pendingData.meshOptimized) {
+            optimizeMeshes(pendingData);
+        }
+
+        // Split before simplifying, levels of detail index the vertices of their own part
+        if (pendingData.indicesSplit) {
+            splitMeshes(pendingData);
+        }
+
+        if (pendingData.lodsGenerated) {
+            generateLods(pendingData);
+        }
+
+        MeshCache::write(path, pendingData);
+    }
+
+    setProgress(LOAD_PROGRESS_IMPORTED);
+
+    minBounds = pendingData.minBounds;
+    maxBounds = pendingData.maxBounds;
+    needFlip = pendingData.needFlip;
+
+    sourceStats = pendingData.sourceStats;
+    stats.meshCount = pendingData.meshes.size();
+    for (const MeshData& meshData : pendingData.meshes) {
+        stats.vertexCount += meshData.vertices.size();
+        stats.indexCount += meshData.indices.size();
+        stats.transformedVertices += MeshOptimizer::simulateVertexCache(meshData.indices, meshData.vertices.size());
+
+        // Same choice as the mesh makes on upload
+        bool shortIndices = Mesh::fitsShortIndices(meshData.vertices.size());
+        if (shortIndices) {
+            stats.shortIndexMeshes++;
+            stats.shortIndexCount += meshData.indices.size();
+        }
+
+        stats.lodCount += meshData.lodChain.levels.size();
+        stats.lodIndexCount += meshData.lodChain.indices.size();
+        stats.lodIndexBytes += meshData.lodChain.indices.size() * (shortIndices ? sizeof(GLushort) : sizeof(GLuint));
+    }
+
+    // Built from the float vertices, before packing and before the mesh data goes away. Its
+    // triangle copy outweighs the geometry lean residency frees, so lean models cannot be picked
+    if (!settings.leanResidency) {
+        auto bvhStart = std::chrono::steady_clock::now();
+        bvh.build(pendingData.meshes);
+        bvhBuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - bvhStart).count();
+    }
+
+    if (settings.packedVertices) {
+        packVertices(pendingData);
+        stats.vertexSize = sizeof(PackedVertex);
+    }
+
+    decodeTextures(pendingData);
+
+    setProgress(LOAD_PROGRESS_DECODED);
+
+    loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Model::importModel(const std::string &path, ModelData& data) {
+    // Local so the scene is freed as soon as it has been converted
+    Assimp::Importer import;
+
+    // Importer takes ownership of its progress handler
+    import.SetProgressHandler(new ImportProgressHandler(progress));
+
+    // Single import, the UV flip is decided and applied while converting the meshes
+    const aiScene* scene = import.ReadFile(path, getImportFlags(ImportProfile::FAST));
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
-        return;
+        return false;
     }
 
-    bool globalFlip = shouldFlipModel(scene);
+    // Count the triangulated geometry, then run the profile's optimization passes on it
+    data.sourceStats = ModelStats();
+    data.sourceStats.meshCount = scene->mNumMeshes;
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
+        const aiMesh* mesh = scene->mMeshes[m];
+        std::vector<GLuint> indices;
 
-    // Check whether model does not require UV flip
-    if (!globalFlip) {
+        for (unsigned int f = 0; f < mesh->mNumFaces; f++) {
+            indices.insert(indices.end(), mesh->mFaces[f].mIndices, mesh->mFaces[f].mIndices + mesh->mFaces[f].mNumIndices);
+        }
+
+        data.sourceStats.vertexCount += mesh->mNumVertices;
+        data.sourceStats.indexCount += indices.size();
+        data.sourceStats.transformedVertices += MeshOptimizer::simulateVertexCache(indices, mesh->mNumVertices);
+    }
+
+    unsigned int optimizationFlags = getImportFlags(data.profile) & ~getImportFlags(ImportProfile::FAST);
+    if (optimizationFlags != 0) {
+        // Only triangles are drawn, drop the points and lines left by degenerate faces
+        import.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
+        import.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
 
-        scene = importWithoutFlip.ReadFile(path, aiProcess_Triangulate | aiProcess_GenNormals);
+        scene = import.ApplyPostProcessing(optimizationFlags);
 
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            std::cout << "ERROR::ASSIMP::" << importWithoutFlip.GetErrorString() << std::endl;
-            return;
+        if (!scene) {
+            std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+            return false;
         }
     }
-    
-    // Save model directory
-    directory = path.substr(0, path.find_last_of('/'));
-    processNode(scene->mRootNode, scene);
+
+    // Drop anything left by a partially read cache entry
+    data.meshes.clear();
+    uvMeshes.clear();
+    flipVotes = 0;
+    processNode(scene->mRootNode, scene, data);
+
+    data.needFlip = shouldFlipModel();
+    if (data.needFlip) {
+        flipTextureCoords(data);
+    }
+
+    return true;
 }
 
-bool Model::shouldFlipModel(const aiScene* scene) {
-    int flipCount = 0;
-    int totalCount = 0;
-    
-    for (unsigned int m = 0; m < scene->mNumMeshes; m++) {
-        aiMesh* mesh = scene->mMeshes[m];
+void Model::optimizeMeshes(ModelData& data) {
+    ThreadPool::getShared().parallelFor(data.meshes.size(), [&data](size_t i) {
+        MeshOptimizer::optimize(data.meshes[i]);
+    });
+}
+
+void Model::splitMeshes(ModelData& data) {
+    std::vector<MeshData> meshes;
+    meshes.reserve(data.meshes.size());
 
-        if (!mesh->HasTextureCoords(0)) continue;
+    for (MeshData& meshData : data.meshes) {
+        size_t vertexCount = meshData.vertices.size();
 
-        totalCount++;
-        if (meshRequireFlip(mesh)) {
-            flipCount++;
+        if (Mesh::fitsShortIndices(vertexCount) || vertexCount > size_t(MAX_SHORT_INDEX_VERTICES) * INDEX_SPLIT_MAX_PARTS) {
+            meshes.push_back(std::move(meshData));
+            continue;
+        }
+
+        for (MeshData& part : MeshOptimizer::splitMesh(meshData)) {
+            meshes.push_back(std::move(part));
         }
     }
-    
-    if (totalCount == 0) return false; // no UVs in any mesh
 
-    // If more than half requires flipping, whole model likely requires flipping
-    return (flipCount > totalCount / 2);
+    data.meshes = std::move(meshes);
 }
 
-bool Model::meshRequireFlip(const aiMesh* mesh) {
-    float minV = 1.0f;
-    float maxV = 0.0f;
+void Model::generateLods(ModelData& data) {
+    bool optimizeLevels = data.meshOptimized;
+
+    ThreadPool::getShared().parallelFor(data.meshes.size(), [&data, optimizeLevels](size_t i) {
+        MeshData& meshData = data.meshes[i];
+        MeshLodChain& chain = meshData.lodChain;
+        chain = MeshLodChain();
+
+        if (meshData.vertices.empty()) return;
+
+        // Errors are limited relative to the size of the mesh
+        glm::vec3 minBounds(FLT_MAX);
+        glm::vec3 maxBounds(-FLT_MAX);
+        for (const Vertex& vertex : meshData.vertices) {
+            minBounds = glm::min(minBounds, vertex.position);
+            maxBounds = glm::max(maxBounds, vertex.position);
+        }
+        float maxError = glm::length(maxBounds - minBounds) * 0.5f * LOD_MAX_RELATIVE_ERROR;
+
+        std::vector<GLuint> previous = meshData.indices;
+        float error = 0.0f;
+
+        for (unsigned int level = 1; level < LOD_MAX_LEVELS; level++) {
+            size_t targetIndexCount = size_t(float(previous.size()) * LOD_REDUCTION_RATIO) / 3 * 3;
+            if (targetIndexCount < LOD_MIN_TRIANGLES * 3) break;
+
+            float levelError = 0.0f;
+            std::vector<GLuint> indices = MeshSimplifier::simplify(meshData.vertices, previous, targetIndexCount, maxError - error, levelError);
+
+            // Stop once the mesh cannot be reduced much further within the error limit
+            if (indices.empty() || float(indices.size()) > float(previous.size()) * LOD_MAX_KEPT_RATIO) break;
+
+            if (optimizeLevels) {
+                MeshOptimizer::optimizeVertexCache(indices, meshData.vertices.size());
+            }
+
+            // Each level is simplified from the previous one, so the errors add up
+            error += levelError;
+
+            chain.levels.push_back(MeshLod{ GLuint(chain.indices.size()), GLsizei(indices.size()), error });
+            chain.indices.insert(chain.indices.end(), indices.begin(), indices.end());
+
+            previous = std::move(indices);
+        }
+    });
+}
+
+void Model::packVertices(ModelData& data) {
+    std::vector<PackingError> errors(data.meshes.size());
 
-    for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-        float v = mesh->mTextureCoords[0][i].y; // Access the y coordinate
-        minV = std::min(minV, v);
-        maxV = std::max(maxV, v);
+    ThreadPool::getShared().parallelFor(data.meshes.size(), [&data, &errors](size_t i) {
+        MeshData& meshData = data.meshes[i];
+        meshData.packed = VertexPacker::pack(meshData.vertices);
+        errors[i] = VertexPacker::measureError(meshData.vertices, meshData.packed);
+    });
+
+    packingError = PackingError();
+    for (const PackingError& error : errors) {
+        packingError.merge(error);
+    }
+}
+
+unsigned int Model::getImportFlags(ImportProfile profile) {
+    unsigned int flags = aiProcess_Triangulate | aiProcess_GenNormals;
+
+    switch (profile) {
+        case ImportProfile::FAST:
+            break;
+
+        // Weld duplicated vertices and reorder triangles for the post-transform cache
+        case ImportProfile::OPTIMIZED:
+            flags |= aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality | aiProcess_RemoveRedundantMaterials |
+                     aiProcess_SortByPType | aiProcess_OptimizeMeshes;
+            break;
+
+        // Also clean up broken data and merge the node graph so meshes sharing a material can be joined
+        case ImportProfile::MAX_QUALITY:
+            flags |= aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality | aiProcess_RemoveRedundantMaterials |
+                     aiProcess_SortByPType | aiProcess_OptimizeMeshes | aiProcess_OptimizeGraph |
+                     aiProcess_FindDegenerates | aiProcess_FindInvalidData | aiProcess_FixInfacingNormals |
+                     aiProcess_ValidateDataStructure;
+            break;
     }
 
+    return flags;
+}
+
+bool Model::upload(double budget) {
+    if (uploaded) return true;
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Upload the decoded textures first, meshes only reference their IDs
+    while (uploadedTextures < pendingImages.size()) {
+        DecodedImage& image = pendingImages[uploadedTextures];
+        const std::string& path = pendingTexturePaths[uploadedTextures];
+
+        // Failed decodes are left out, their meshes fall back to the null texture
+        if (image.pixels) {
+            textures_loaded[path] = TextureCache::getShared().acquire(image);
+        }
+
+        // Release the CPU copy as soon as it is on the GPU
+        pendingImages[uploadedTextures].pixels.reset();
+        uploadedTextures++;
+
+        if (elapsed() >= budget) {
+            loadTime += elapsed();
+            setUploadProgress();
+            return false;
+        }
+    }
+
+    while (uploadedMeshes < pendingData.meshes.size()) {
+        MeshData& meshData = pendingData.meshes[uploadedMeshes];
+        loadMaterialTextures(meshData.textures);
+
+        // If mesh contains no texture, render the shared null texture
+        if (meshData.textures.empty()) {
+            Texture defaultTexture;
+            defaultTexture.id = applyNullTexture(); 
+            defaultTexture.type = "texture_diffuse";
+            meshData.textures.push_back(defaultTexture);
+        }
+
+        meshes.push_back(std::make_unique<Mesh>(std::move(meshData.vertices), std::move(meshData.indices), std::move(meshData.textures), meshData.shininess, meshData.packed, meshData.lodChain));
+        meshVisible.push_back(1);
+
+        // Meshes without vertices keep unbounded bounds and are never culled
+        if (meshData.minBounds.x <= meshData.maxBounds.x) {
+            meshes.back()->setBounds(meshData.minBounds, meshData.maxBounds);
+        }
+
+        // The packed copy and the levels of detail are only needed for the upload
+        meshData.packed = PackedVertexData();
+        meshData.lodChain = MeshLodChain();
+
+        if (settings.leanResidency) {
+            meshes.back()->releaseGeometry();
+        }
+        uploadedMeshes++;
+
+        if (elapsed() >= budget && uploadedMeshes < pendingData.meshes.size()) {
+            loadTime += elapsed();
+            setUploadProgress();
+            return false;
+        }
+    }
+
+    loadTime += elapsed();
+
+    // Everything is on the GPU, drop the staging data
+    pendingData = ModelData();
+    pendingImages.clear();
+    pendingTexturePaths.clear();
+    uploaded = true;
+    setProgress(1.0f);
+
+    std::cout << "Loaded " << modelPath << " in " << loadTime << " ms (" << (loadedFromCache ? "warm, mesh cache" : "cold, Assimp import") << ")" << std::endl;
+    std::cout << "  " << ImportProfileSelection::names[(int) settings.importProfile] << " profile: "
+              << sourceStats.meshCount << " -> " << stats.meshCount << " meshes, "
+              << sourceStats.vertexCount << " -> " << stats.vertexCount << " vertices, "
+              << sourceStats.indexCount << " -> " << stats.indexCount << " indices, "
+              << sourceStats.getBufferBytes() << " -> " << stats.getBufferBytes() << " buffer bytes, ACMR "
+              << sourceStats.getAcmr() << " -> " << stats.getAcmr() << ", ATVR "
+              << sourceStats.getAtvr() << " -> " << stats.getAtvr() << std::endl;
+    std::cout << "  16-bit indices: " << stats.shortIndexMeshes << " of " << stats.meshCount << " meshes, "
+              << sourceStats.getIndexBytes() << " -> " << stats.getIndexBytes() << " index bytes, "
+              << stats.getIndexBytesSaved() << " bytes less index fetch per frame" << std::endl;
+
+    if (stats.lodCount > 0) {
+        std::cout << "  levels of detail: " << stats.lodCount << " over " << stats.meshCount << " meshes, "
+                  << stats.lodIndexCount / 3 << " simplified triangles, " << stats.lodIndexBytes << " index bytes" << std::endl;
+    }
+
+    if (settings.packedVertices) {
+        std::cout << "  packed vertices: " << stats.vertexCount * sizeof(Vertex) << " -> " << stats.vertexCount * sizeof(PackedVertex)
+                  << " vertex bytes, max error " << packingError.maxPositionError << " position, "
+                  << packingError.maxNormalError << " deg normal, " << packingError.maxTexCoordError << " UV" << std::endl;
+    }
+
+    return true;
+}
+
+void Model::setProgress(float value) {
+    if (progress) progress->store(value);
+}
+
+void Model::setUploadProgress() {
+    size_t total = pendingImages.size() + pendingData.meshes.size();
+    if (total == 0) return;
+
+    float fraction = float(uploadedTextures + uploadedMeshes) / float(total);
+    setProgress(LOAD_PROGRESS_DECODED + fraction * (1.0f - LOAD_PROGRESS_DECODED));
+}
+
+void Model::decodeTextures(const ModelData& data) {
+    std::vector<std::string> paths;
+    std::unordered_set<std::string> seen;
+
+    // Gather every texture not loaded yet, once each
+    for (const MeshData& meshData : data.meshes) {
+        for (const Texture& texture : meshData.textures) {
+            if (textures_loaded.count(texture.path) == 0 && seen.insert(texture.path).second) {
+                paths.push_back(texture.path);
+            }
+        }
+    }
+
+    if (paths.empty()) return;
+
+    // Resident textures are acquired now, holding a reference keeps them from being evicted
+    // before the upload. Acquiring only counts references, it is safe off the GL thread
+    std::vector<GLuint> resident(paths.size());
+    ThreadPool::getShared().parallelFor(paths.size(), [&](size_t i) {
+        resident[i] = TextureCache::getShared().acquire(directory + '/' + paths[i]);
+    });
+
+    std::vector<std::string> filenames;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (resident[i] != 0) {
+            textures_loaded[paths[i]] = resident[i];
+        } else {
+            filenames.push_back(directory + '/' + paths[i]);
+            pendingTexturePaths.push_back(paths[i]);
+        }
+    }
+
+    if (filenames.empty()) return;
+
+    // Decode concurrently, the upload happens later as one batch on the GL thread
+    std::atomic<size_t> decoded = 0;
+    std::vector<DecodedImage> images = TextureLoader::decodeAll(filenames, [&](size_t) {
+        float fraction = float(++decoded) / float(filenames.size());
+        setProgress(LOAD_PROGRESS_IMPORTED + fraction * (LOAD_PROGRESS_DECODED - LOAD_PROGRESS_IMPORTED));
+    });
+
+    pendingImages = std::move(images);
+}
+
+bool Model::shouldFlipModel() const {
+    if (uvMeshes.empty()) return false; // no UVs in any mesh
+
+    // If more than half requires flipping, whole model likely requires flipping
+    return (flipVotes > uvMeshes.size() / 2);
+}
+
+bool Model::meshRequireFlip(float minV, float maxV) {
     // Indicate full height UV map used therefore needs flipping
     return (maxV > 0.9f && minV < 0.1f);
 }
 
+void Model::flipTextureCoords(ModelData& data) {
+    for (size_t m : uvMeshes) {
+        for (Vertex& vertex : data.meshes[m].vertices) {
+            vertex.texCoords.y = 1.0f - vertex.texCoords.y;
+        }
+    }
+}
+
 // aiScene is the top level object containing all the model info eg: meshes, textures
 // aiNode is a single node within the scene, does not store mesh directly but holds indice to mesh within aiScene
-void Model::processNode(aiNode *node, const aiScene *scene) {
+void Model::processNode(aiNode *node, const aiScene *scene, ModelData& data) {
     // process all the node’s meshes (if any)
     for(unsigned int i = 0; i < node->mNumMeshes; i++) {
         aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
+        data.meshes.push_back(processMesh(mesh, scene, data));
     }
     // then do the same for each of its children
     for(unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, data);
     }
 }
 
 // MMesh: Positions, Normals and texture coordinate
-std::unique_ptr<Mesh> Model::processMesh(aiMesh *mesh, const aiScene *scene) {
-    float shininess = DEFAULT_SHININESS;
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
+MeshData Model::processMesh(aiMesh *mesh, const aiScene *scene, ModelData& data) {
+    MeshData meshData;
+    std::vector<Vertex>& vertices = meshData.vertices;
+    std::vector<GLuint>& indices = meshData.indices;
+    std::vector<Texture>& textures = meshData.textures;
+
+    // V range of the mesh, gathered for the UV flip decision
+    float minV = 1.0f;
+    float maxV = 0.0f;
 
     for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
         Vertex vertex;
@@ -143,9 +701,11 @@ std::unique_ptr<Mesh> Model::processMesh(aiMesh *mesh, const aiScene *scene) {
         vector.z = mesh->mVertices[i].z;
         vertex.position = vector;
 
-        // Get model's largest and smallest vector position values
-        minBounds = glm::min(minBounds, vector);
-        maxBounds = glm::max(maxBounds, vector);
+        // Get model's and mesh's largest and smallest vector position values
+        data.minBounds = glm::min(data.minBounds, vector);
+        data.maxBounds = glm::max(data.maxBounds, vector);
+        meshData.minBounds = glm::min(meshData.minBounds, vector);
+        meshData.maxBounds = glm::max(meshData.maxBounds, vector);
 
         // Vertex normals
         vector.x = mesh->mNormals[i].x;
@@ -160,6 +720,9 @@ std::unique_ptr<Mesh> Model::processMesh(aiMesh *mesh, const aiScene *scene) {
             vec.x = mesh->mTextureCoords[0][i].x;
             vec.y = mesh->mTextureCoords[0][i].y;
             vertex.texCoords = vec;
+
+            minV = std::min(minV, vec.y);
+            maxV = std::max(maxV, vec.y);
         } else {
             vertex.texCoords = glm::vec2(0.0f, 0.0f);
         }
@@ -167,6 +730,12 @@ std::unique_ptr<Mesh> Model::processMesh(aiMesh *mesh, const aiScene *scene) {
         vertices.push_back(vertex);
     }
 
+    if (mesh->HasTextureCoords(0)) {
+        // Index the mesh will have once added to the model data
+        uvMeshes.push_back(data.meshes.size());
+        if (meshRequireFlip(minV, maxV)) flipVotes++;
+    }
+
     // Process indices on each (in our case) triangle face of the model
     for(unsigned int i = 0; i < mesh->mNumFaces; i++) {
         aiFace face = mesh->mFaces[i];
@@ -181,27 +750,27 @@ std::unique_ptr<Mesh> Model::processMesh(aiMesh *mesh, const aiScene *scene) {
         aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
 
         // Read map_Kd value
-        std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
+        std::vector<Texture> diffuseMaps = readMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
         textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
 
         // Read map_Ks value
-        std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
+        std::vector<Texture> specularMaps = readMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
         textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
 
         // Read map_Bump
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
+        std::vector<Texture> normalMaps = readMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
         textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
 
         // Read map_AO
-        std::vector<Texture> aoMaps = loadMaterialTextures(material, aiTextureType_LIGHTMAP, "texture_ao");
+        std::vector<Texture> aoMaps = readMaterialTextures(material, aiTextureType_LIGHTMAP, "texture_ao");
         textures.insert(textures.end(), aoMaps.begin(), aoMaps.end());
 
         // Read map_Pr
-        std::vector<Texture> roughnessMaps = loadMaterialTextures(material, aiTextureType_SHININESS, "texture_roughness");
+        std::vector<Texture> roughnessMaps = readMaterialTextures(material, aiTextureType_SHININESS, "texture_roughness");
         textures.insert(textures.end(), roughnessMaps.begin(), roughnessMaps.end());
 
         // Read map_Pm
-        std::vector<Texture> metallicMaps = loadMaterialTextures(material, aiTextureType_REFLECTION, "texture_metallic");
+        std::vector<Texture> metallicMaps = readMaterialTextures(material, aiTextureType_REFLECTION, "texture_metallic");
         textures.insert(textures.end(), metallicMaps.begin(), metallicMaps.end());
 
         // Apply shine if specular material is present
@@ -209,41 +778,24 @@ std::unique_ptr<Mesh> Model::processMesh(aiMesh *mesh, const aiScene *scene) {
             float shininess_value;
 
             if (AI_SUCCESS == material->Get(AI_MATKEY_SHININESS, shininess_value)) {
-                shininess = shininess_value;
+                meshData.shininess = shininess_value;
             }
         }
     }
 
-    // If mesh contains no texture, render a default null texture
-    if (textures.empty()) {
-        Texture defaultTexture;
-        defaultTexture.id = applyNullTexture(); 
-        defaultTexture.type = "texture_diffuse";
-        textures.push_back(defaultTexture);
-    }
-
-    return std::make_unique<Mesh>(vertices, indices, textures, shininess);
+    return meshData;
 }
 
 unsigned int Model::applyNullTexture() {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    // White color
-    unsigned char whitePixel[3] = { 255, 255, 255 };
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, whitePixel);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (nullTexture == 0) {
+        nullTexture = TextureCache::getShared().acquireNullTexture();
+    }
 
-    return textureID;
+    return nullTexture;
 }
 
-// Load all textures found within the given material
-std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName) {
+// Read all textures referenced by the given material
+std::vector<Texture> Model::readMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName) {
     std::vector<Texture> textures;
 
     // Iterate over all textures of given type
@@ -252,76 +804,30 @@ std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType
         
         // Store texture path within str
         mat->GetTexture(type, i, &str);
-        bool skip = false;
-
-        // Iterate over already loaded textures to prevent duplicate loading
-        for(unsigned int j = 0; j < textures_loaded.size(); j++) {
 
-            // Texture has already been processed
-            if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0) {
-                textures.push_back(textures_loaded[j]);
-                skip = true;
-                break;
-            }
-        }
-        
-        // Texture hasn’t been loaded already, load it into the global textures vector
-        if(!skip) { 
-            Texture texture;
-            texture.id = textureFromFile(str.C_Str(), directory);
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-            textures_loaded.push_back(texture); 
-        }
+        Texture texture;
+        texture.id = 0;
+        texture.type = typeName;
+        texture.path = str.C_Str();
+        textures.push_back(texture);
     }
 
     return textures;
 }
 
-unsigned int Model::textureFromFile(const std::string &path, const std::string &directory){
-    // texture file name
-    std::string filename = directory + '/' + path;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    // nrComponents inform us of the number of color components within the given image
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-
-    if (data)
-    {
-        GLenum format;
-        // Grayscale
-        if (nrComponents == 1)
-            format = GL_RED;
-        // Standard Color
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        // Include transparency
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
+// Load all textures bound to a mesh
+void Model::loadMaterialTextures(std::vector<Texture>& textures) {
+    for (Texture& texture : textures) {
+        auto it = textures_loaded.find(texture.path);
 
-        // Creates texture and sends it to GPU
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // Texture has already been acquired by this model
+        if (it != textures_loaded.end()) {
+            texture.id = it->second;
+            continue;
+        }
 
-        stbi_image_free(data);
+        // The image could not be decoded, never retry from disk on the GL thread
+        texture.id = applyNullTexture();
     }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
 }
+
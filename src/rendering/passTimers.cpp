@@ -0,0 +1,39 @@
+#include "rendering/passTimers.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+PassTimers::PassTimers() {
+    timers.reserve((size_t) RenderPass::COUNT);
+    for (int i = 0; i < (int) RenderPass::COUNT; i++) {
+        timers.push_back(std::make_unique<GpuTimer>(PASS_TIMER_QUERIES));
+    }
+}
+
+void PassTimers::begin(RenderPass pass) {
+    running[(int) pass] = timers[(int) pass]->tryBegin();
+    drawn[(int) pass] = true;
+}
+
+void PassTimers::end(RenderPass pass) {
+    if (running[(int) pass]) timers[(int) pass]->end();
+    running[(int) pass] = false;
+}
+
+void PassTimers::endFrame() {
+    for (int i = 0; i < (int) RenderPass::COUNT; i++) {
+        timers[i]->update();
+
+        // Keep the newest result, the older ones would only lag the graphs
+        double milliseconds;
+        while (timers[i]->takeResult(milliseconds)) {
+            times.milliseconds[i] = (float) milliseconds;
+        }
+
+        if (!drawn[i]) times.milliseconds[i] = 0.0f;
+        drawn[i] = false;
+    }
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+
+#include "rendering/renderQueue.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+void RenderQueue::submit(ShaderProgram& shader, const Mesh& mesh, float depth, GLsizei instanceCount, bool instancedDraw) {
+    packets.push_back({ &shader, &mesh, mesh.getMaterialKey(), depth, instanceCount, instancedDraw });
+}
+
+void RenderQueue::execute() {
+    std::sort(packets.begin(), packets.end(), [](const Packet& a, const Packet& b) {
+        if (a.shader->ID() != b.shader->ID()) return a.shader->ID() < b.shader->ID();
+        if (a.materialKey != b.materialKey) return a.materialKey < b.materialKey;
+        if (a.depth != b.depth) return a.depth < b.depth;
+        return a.mesh->getVAO() < b.mesh->getVAO();
+    });
+
+    stats = RenderQueueStats();
+    stats.packets = packets.size();
+
+    // State left by the previous packet, nothing is assumed bound at the start of the frame
+    GLuint currentProgram = 0;
+    GLuint currentVao = 0;
+    boundTextures.assign(boundTextures.size(), 0);
+    const Mesh* materialMesh = nullptr;
+    const Mesh* decodeMesh = nullptr;
+    GLint instanced = -1;
+
+    for (const Packet& packet : packets) {
+        const Mesh& mesh = *packet.mesh;
+        ShaderProgram& shader = *packet.shader;
+
+        // Texture binds, material uniforms, decode uniforms, instancing uniform and VAO bind and unbind
+        size_t textureCount = mesh.getTextures().size();
+        stats.naiveStateChanges += textureCount + (textureCount + 3) + 3 + 1 + 2;
+
+        if (shader.ID() != currentProgram) {
+            shader.use();
+            currentProgram = shader.ID();
+            stats.stateChanges++;
+
+            // Uniforms belong to the program, set them again for the new one
+            materialMesh = nullptr;
+            decodeMesh = nullptr;
+            instanced = -1;
+        }
+
+        if (!materialMesh || materialMesh->getMaterialKey() != packet.materialKey) {
+            stats.stateChanges += mesh.bindMaterial(shader, boundTextures);
+            materialMesh = &mesh;
+        }
+
+        const VertexQuantization& quantization = mesh.getQuantization();
+        bool sameDecode = decodeMesh && decodeMesh->isPackedLayout() == mesh.isPackedLayout() &&
+                          decodeMesh->getQuantization().positionScale == quantization.positionScale &&
+                          decodeMesh->getQuantization().positionOffset == quantization.positionOffset;
+
+        if (!sameDecode) {
+            // Identity decode for the float layout
+            shader.setUniform("positionScale"_uniform, quantization.positionScale);
+            shader.setUniform("positionOffset"_uniform, quantization.positionOffset);
+            shader.setUniform("octNormals"_uniform, (GLint) mesh.isPackedLayout());
+            decodeMesh = &mesh;
+            stats.stateChanges += 3;
+        }
+
+        GLint packetInstanced = packet.instanceCount > 0;
+        if (packetInstanced != instanced) {
+            shader.setUniform("instanced"_uniform, packetInstanced);
+            instanced = packetInstanced;
+            stats.stateChanges++;
+        }
+
+        if (mesh.getVAO() != currentVao) {
+            glBindVertexArray(mesh.getVAO());
+            currentVao = mesh.getVAO();
+            stats.stateChanges++;
+        }
+
+        mesh.drawElements(packet.instanceCount, packet.instancedDraw);
+    }
+
+    if (currentVao != 0) {
+        glBindVertexArray(0);
+        stats.stateChanges++;
+    }
+
+    // reset to default texture
+    glActiveTexture(GL_TEXTURE0);
+
+    packets.clear();
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+
+#include "rendering/renderTarget.hpp"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+bool RenderTarget::create(int newWidth, int newHeight) {
+    reset();
+
+    width = newWidth;
+    height = newHeight;
+
+    colorBuffer = GlRenderbuffer::create();
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    colorBuffer.track(GpuMemoryCategory::RenderTargets, (size_t) width * height * 4);
+
+    depthBuffer = GlRenderbuffer::create();
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    depthBuffer.track(GpuMemoryCategory::RenderTargets, (size_t) width * height * 4);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    framebuffer = GlFramebuffer::create();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer.get());
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer.get());
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "RenderTarget: framebuffer of " << width << "x" << height << " is incomplete, status 0x" << std::hex << status << std::dec << std::endl;
+        reset();
+        return false;
+    }
+
+    return true;
+}
+
+void RenderTarget::reset() {
+    framebuffer.reset();
+    colorBuffer.reset();
+    depthBuffer.reset();
+    width = 0;
+    height = 0;
+}
+
+void RenderTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glViewport(0, 0, width, height);
+}
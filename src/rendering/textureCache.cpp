@@ -0,0 +1,217 @@
+#include <iostream>
+#include <filesystem>
+#include <cstdio>
+
+#include "rendering/textureCache.hpp"
+#include "utils/mappedFile.hpp"
+#include "utils/hash.hpp"
+
+// Key of the shared white texture, cannot collide with a file key
+#define NULL_TEXTURE_KEY "<null>"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+TextureCache& TextureCache::getShared() {
+    static TextureCache cache;
+    return cache;
+}
+
+bool TextureCache::contains(const std::string& filename) {
+    std::string key = getKey(filename);
+    if (key.empty()) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.find(key) != entries.end();
+}
+
+GLuint TextureCache::acquire(const std::string& filename) {
+    std::string key = getKey(filename);
+    if (key.empty()) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find(key);
+    if (it == entries.end()) return 0;
+
+    hits++;
+    return addReference(it->second);
+}
+
+GLuint TextureCache::acquire(const DecodedImage& image) {
+    std::string key = getKey(image.filename);
+
+    // Unreadable files still get a (empty) texture, keyed by name so it is only created once
+    if (key.empty()) key = image.filename;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            hits++;
+            return addReference(it->second);
+        }
+    }
+
+    // Upload outside the lock so worker lookups are not held up
+    GlTexture texture = TextureLoader::upload(image);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto [it, inserted] = entries.try_emplace(key);
+    if (!inserted) {
+        // Uploaded by someone else meanwhile, keep theirs, ours is deleted with its handle
+        hits++;
+        return addReference(it->second);
+    }
+
+    misses++;
+    keys[texture.get()] = key;
+    it->second.texture = std::move(texture);
+    return addReference(it->second);
+}
+
+GLuint TextureCache::acquireNullTexture() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto [it, inserted] = entries.try_emplace(NULL_TEXTURE_KEY);
+    if (inserted) {
+        GlTexture texture = GlTexture::create();
+        glBindTexture(GL_TEXTURE_2D, texture.get());
+
+        // White color
+        unsigned char whitePixel[3] = { 255, 255, 255 };
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, whitePixel);
+        texture.track(GpuMemoryCategory::Textures, 4);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        keys[texture.get()] = NULL_TEXTURE_KEY;
+        it->second.texture = std::move(texture);
+    }
+
+    return addReference(it->second);
+}
+
+void TextureCache::release(GLuint id) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto keyIt = keys.find(id);
+    if (keyIt == keys.end()) return; // already deleted by clear()
+
+    Entry& entry = entries[keyIt->second];
+    if (entry.refCount == 0) {
+        std::cerr << "TextureCache: texture " << id << " released more often than acquired" << std::endl;
+        return;
+    }
+
+    if (--entry.refCount == 0) {
+        released.push_front(keyIt->second);
+        entry.released = released.begin();
+        entry.isReleased = true;
+        evict();
+    }
+}
+
+void TextureCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // The handles delete the textures
+    entries.clear();
+    keys.clear();
+    released.clear();
+}
+
+void TextureCache::setCapacity(size_t newCapacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    capacity = newCapacity;
+    evict();
+}
+
+size_t TextureCache::getCapacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity;
+}
+
+size_t TextureCache::getResidentCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t TextureCache::getHits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t TextureCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+std::string TextureCache::getKey(const std::string& filename) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(filename, error);
+    if (error) return "";
+    int64_t modifiedTime = std::filesystem::last_write_time(filename, error).time_since_epoch().count();
+    if (error) return "";
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = stamps.find(filename);
+        if (it != stamps.end() && it->second.modifiedTime == modifiedTime && it->second.size == size) {
+            return it->second.key;
+        }
+    }
+
+    // Hash outside the lock, this reads the whole file
+    MappedFile file(filename);
+    if (!file.isValid()) return "";
+
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(filename, error);
+    if (error) canonical = filename;
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long) hashBytes(file.getData(), file.getSize()));
+    std::string key = canonical.string() + '#' + hash;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stamps[filename] = FileStamp{ modifiedTime, size, key };
+
+    return key;
+}
+
+void TextureCache::evict() {
+    while (released.size() > capacity) {
+        auto it = entries.find(released.back());
+        released.pop_back();
+
+        keys.erase(it->second.texture.get());
+        entries.erase(it);
+    }
+}
+
+GLuint TextureCache::addReference(Entry& entry) {
+    // Back in use, no longer a candidate for eviction
+    if (entry.isReleased) {
+        released.erase(entry.released);
+        entry.isReleased = false;
+    }
+
+    entry.refCount++;
+    return entry.texture.get();
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <stb_include/stb_image.h>
+
+#include "rendering/textureLoader.hpp"
+#include "utils/threadPool.hpp"
+
+
+void ImageDeleter::operator()(unsigned char* pixels) const {
+    stbi_image_free(pixels);
+}
+
+DecodedImage TextureLoader::decode(const std::string& filename) {
+    DecodedImage image;
+    image.filename = filename;
+
+    // components inform us of the number of color components within the given image
+    image.pixels.reset(stbi_load(filename.c_str(), &image.width, &image.height, &image.components, 0));
+
+    return image;
+}
+
+std::vector<DecodedImage> TextureLoader::decodeAll(const std::vector<std::string>& filenames, const std::function<void(size_t)>& onDecoded) {
+    std::vector<DecodedImage> images(filenames.size());
+
+    ThreadPool::getShared().parallelFor(filenames.size(), [&](size_t i) {
+        images[i] = decode(filenames[i]);
+
+        if (onDecoded) onDecoded(i);
+    });
+
+    return images;
+}
+
+GlTexture TextureLoader::upload(const DecodedImage& image) {
+    GlTexture texture = GlTexture::create();
+
+    if (!image.pixels) {
+        std::cout << "Texture failed to load at path: " << image.filename << std::endl;
+        return texture;
+    }
+
+    GLenum format = GL_RGB;
+    // Grayscale
+    if (image.components == 1)
+        format = GL_RED;
+    // Grayscale with alpha
+    else if (image.components == 2)
+        format = GL_RG;
+    // Standard Color
+    else if (image.components == 3)
+        format = GL_RGB;
+    // Include transparency
+    else if (image.components == 4)
+        format = GL_RGBA;
+
+    glBindTexture(GL_TEXTURE_2D, texture.get());
+
+    // Creates texture and sends it to GPU
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.get());
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    // Drivers store RGB texels padded to four bytes, and the mipmap chain adds a third
+    size_t texelBytes = image.components == 3 ? 4 : (size_t) image.components;
+    texture.track(GpuMemoryCategory::Textures, (size_t) image.width * image.height * texelBytes * 4 / 3);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return texture;
+}
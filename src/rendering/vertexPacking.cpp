@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "rendering/vertexPacking.hpp"
+
+
+/**
+ * @brief Converts a value in [-1, 1] to a signed normalized 16-bit integer
+ */
+static int16_t toSnorm16(float value) {
+    return (int16_t) std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+/**
+ * @brief Converts a signed normalized 16-bit integer to [-1, 1] like OpenGL does
+ */
+static float fromSnorm16(int16_t value) {
+    return std::max(float(value) / 32767.0f, -1.0f);
+}
+
+/**
+ * @brief Converts a value in [0, 1] to an unsigned normalized 16-bit integer
+ */
+static uint16_t toUnorm16(float value) {
+    return (uint16_t) std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+/**
+ * @brief Converts an unsigned normalized 16-bit integer to [0, 1] like OpenGL does
+ */
+static float fromUnorm16(uint16_t value) {
+    return float(value) / 65535.0f;
+}
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+void PackingError::merge(const PackingError& other) {
+    maxPositionError = std::max(maxPositionError, other.maxPositionError);
+    maxNormalError = std::max(maxNormalError, other.maxNormalError);
+    maxTexCoordError = std::max(maxTexCoordError, other.maxTexCoordError);
+}
+
+PackedVertexData VertexPacker::pack(const std::vector<Vertex>& vertices) {
+    PackedVertexData packed;
+    if (vertices.empty()) return packed;
+
+    glm::vec3 minBounds(FLT_MAX);
+    glm::vec3 maxBounds(-FLT_MAX);
+    bool unitTexCoords = true;
+
+    for (const Vertex& vertex : vertices) {
+        minBounds = glm::min(minBounds, vertex.position);
+        maxBounds = glm::max(maxBounds, vertex.position);
+
+        unitTexCoords = unitTexCoords && vertex.texCoords.x >= 0.0f && vertex.texCoords.x <= 1.0f &&
+                        vertex.texCoords.y >= 0.0f && vertex.texCoords.y <= 1.0f;
+    }
+
+    VertexQuantization& quantization = packed.quantization;
+    quantization.positionOffset = (minBounds + maxBounds) * 0.5f;
+    quantization.positionScale = (maxBounds - minBounds) * 0.5f;
+    quantization.halfTexCoords = !unitTexCoords;
+
+    // Flat axes keep a zero scale for decoding but must not divide by zero when encoding
+    glm::vec3 inverseScale;
+    for (int i = 0; i < 3; i++) {
+        inverseScale[i] = quantization.positionScale[i] > 0.0f ? 1.0f / quantization.positionScale[i] : 0.0f;
+    }
+
+    packed.vertices.resize(vertices.size());
+
+    for (size_t v = 0; v < vertices.size(); v++) {
+        const Vertex& vertex = vertices[v];
+        PackedVertex& out = packed.vertices[v];
+
+        glm::vec3 position = (vertex.position - quantization.positionOffset) * inverseScale;
+        out.position[0] = toSnorm16(position.x);
+        out.position[1] = toSnorm16(position.y);
+        out.position[2] = toSnorm16(position.z);
+        out.position[3] = 0;
+
+        encodeOctahedral(vertex.normal, out.normal);
+
+        for (int i = 0; i < 2; i++) {
+            out.texCoords[i] = quantization.halfTexCoords ? floatToHalf(vertex.texCoords[i]) : toUnorm16(vertex.texCoords[i]);
+        }
+    }
+
+    return packed;
+}
+
+Vertex VertexPacker::unpack(const PackedVertex& vertex, const VertexQuantization& quantization) {
+    Vertex out;
+
+    glm::vec3 position(fromSnorm16(vertex.position[0]), fromSnorm16(vertex.position[1]), fromSnorm16(vertex.position[2]));
+    out.position = quantization.positionOffset + position * quantization.positionScale;
+
+    out.normal = decodeOctahedral(vertex.normal);
+
+    for (int i = 0; i < 2; i++) {
+        out.texCoords[i] = quantization.halfTexCoords ? halfToFloat(vertex.texCoords[i]) : fromUnorm16(vertex.texCoords[i]);
+    }
+
+    return out;
+}
+
+PackingError VertexPacker::measureError(const std::vector<Vertex>& vertices, const PackedVertexData& packed) {
+    PackingError error;
+
+    for (size_t v = 0; v < vertices.size() && v < packed.vertices.size(); v++) {
+        const Vertex& original = vertices[v];
+        Vertex decoded = unpack(packed.vertices[v], packed.quantization);
+
+        error.maxPositionError = std::max(error.maxPositionError, glm::length(decoded.position - original.position));
+
+        // Degenerate normals cannot be compared
+        float length = glm::length(original.normal);
+        if (length > 0.0f) {
+            float cosine = std::clamp(glm::dot(original.normal / length, decoded.normal), -1.0f, 1.0f);
+            error.maxNormalError = std::max(error.maxNormalError, glm::degrees(std::acos(cosine)));
+        }
+
+        for (int i = 0; i < 2; i++) {
+            error.maxTexCoordError = std::max(error.maxTexCoordError, std::abs(decoded.texCoords[i] - original.texCoords[i]));
+        }
+    }
+
+    return error;
+}
+
+void VertexPacker::encodeOctahedral(const glm::vec3& normal, int16_t encoded[2]) {
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum <= 0.0f) {
+        encoded[0] = encoded[1] = 0;
+        return;
+    }
+
+    // Project onto the octahedron, then fold the lower half over the upper one
+    glm::vec3 n = normal / sum;
+    glm::vec2 e(n.x, n.y);
+
+    if (n.z < 0.0f) {
+        e.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        e.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    encoded[0] = toSnorm16(e.x);
+    encoded[1] = toSnorm16(e.y);
+}
+
+glm::vec3 VertexPacker::decodeOctahedral(const int16_t encoded[2]) {
+    glm::vec3 n(fromSnorm16(encoded[0]), fromSnorm16(encoded[1]), 0.0f);
+    n.z = 1.0f - std::abs(n.x) - std::abs(n.y);
+
+    // Unfold the lower half
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+
+    return glm::normalize(n);
+}
+
+uint16_t VertexPacker::floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t floatExponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    int32_t exponent = int32_t(floatExponent) - 127 + 15;
+
+    // Infinity and NaN
+    if (floatExponent == 0xFFu) return sign | 0x7C00u | (mantissa ? 0x200u : 0u);
+
+    // Too large, clamp to infinity
+    if (exponent >= 31) return sign | 0x7C00u;
+
+    // Subnormal half, or too small and flushed to zero
+    if (exponent <= 0) {
+        if (exponent < -10) return sign;
+
+        mantissa |= 0x800000u;
+        uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) half++;
+        return sign | half;
+    }
+
+    uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFFu;
+
+    // A carry out of the mantissa correctly bumps the exponent
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+    return (uint16_t) half;
+}
+
+float VertexPacker::halfToFloat(uint16_t value) {
+    uint32_t sign = uint32_t(value & 0x8000u) << 16;
+    uint32_t exponent = (value >> 10) & 0x1Fu;
+    uint32_t mantissa = value & 0x3FFu;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        // Zero or subnormal
+        float magnitude = std::ldexp(float(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+
+#include "shader/programCache.hpp"
+#include "utils/mappedFile.hpp"
+#include "utils/hash.hpp"
+#include "config.h"
+
+
+/*****************************************/
+/*            Public Methods             */
+/*****************************************/
+
+
+bool ProgramCache::isSupported() {
+    if (!GLEW_ARB_get_program_binary) return false;
+
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t ProgramCache::getKey(std::initializer_list<std::string_view> sources) {
+    uint64_t key = FNV_OFFSET_BASIS;
+
+    // A binary is only valid for the driver that produced it
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        if (value) key = hashString(value, key);
+        key = hashString(std::string_view("\0", 1), key);
+    }
+
+    // Separators keep moving text between stages from producing the same key
+    for (std::string_view source : sources) {
+        uint64_t length = source.size();
+        key = hashBytes(&length, sizeof(length), key);
+        key = hashString(source, key);
+    }
+
+    return key;
+}
+
+bool ProgramCache::read(uint64_t key, GLuint programID, double& compileTime) {
+    std::string cachePath = getCachePath(key);
+
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath, error)) return false;
+
+    MappedFile cache(cachePath);
+    if (!cache.isValid() || cache.getSize() < sizeof(ProgramCacheHeader)) return false;
+
+    ProgramCacheHeader header;
+    std::memcpy(&header, cache.getData(), sizeof(ProgramCacheHeader));
+
+    if (header.magic != PROGRAM_CACHE_MAGIC || header.version != PROGRAM_CACHE_VERSION) return false;
+    if (header.key != key) return false;
+    if (cache.getSize() - sizeof(ProgramCacheHeader) < header.binaryLength) return false;
+
+    glProgramBinary(programID, header.binaryFormat, cache.getData() + sizeof(ProgramCacheHeader), header.binaryLength);
+
+    // Drivers reject binaries after updates the version string does not reflect
+    GLint success = GL_FALSE;
+    glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::filesystem::remove(cachePath, error);
+        return false;
+    }
+
+    compileTime = header.compileTime;
+    return true;
+}
+
+bool ProgramCache::write(uint64_t key, GLuint programID, double compileTime) {
+    GLint length = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(programID, length, &length, &format, binary.data());
+    if (length <= 0) return false;
+
+    std::string cachePath = getCachePath(key);
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+    if (error) {
+        std::cerr << "ProgramCache: failed to create cache directory for " << cachePath << std::endl;
+        return false;
+    }
+
+    ProgramCacheHeader header = {};
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binaryFormat = format;
+    header.binaryLength = (uint32_t) length;
+    header.compileTime = compileTime;
+
+    // Write to a temporary file first so a partially written binary is never read
+    std::string tempPath = cachePath + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "ProgramCache: failed to open " << tempPath << " for writing" << std::endl;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(binary.data()), length);
+
+    out.close();
+    if (!out) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+
+/*****************************************/
+/*            Private Methods            */
+/*****************************************/
+
+
+std::string ProgramCache::getCachePath(uint64_t key) {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long) key);
+    return std::string(CACHE_PATH) + "shaders/" + name + PROGRAM_CACHE_EXTENSION;
+}
@@ -1,7 +1,29 @@
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
 #include "shader/shader.hpp"
+#include "utils/constants.hpp"
+
+
+/**
+ * @brief Checks whether the current context accepts OPEN_GL_VERSION shaders
+ * 
+ * Queried once, the application never switches to a context of another version.
+ * 
+ * @return True for OpenGL 4.6 and later
+ */
+static bool isGlsl460Supported() {
+    static const bool supported = [] {
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        return major > 4 || (major == 4 && minor >= 6);
+    }();
+
+    return supported;
+}
 
 
 /*****************************************/
@@ -11,70 +33,80 @@
 
 Shader::Shader(ShaderType shaderType, const std::string& sourceFile) {
     this->shaderType = shaderType;
-    this->shaderID = glCreateShader(shaderType);
-    const GLchar* source = nullptr;
+    this->shader = GlShader::create((GLenum) shaderType);
+    std::string source;
     
     // Load and compile source if a file was specified
-    if (!sourceFile.empty() && (source = readSourceFile(sourceFile))) {
-        glShaderSource(shaderID, 1, &source, NULL);
+    if (!sourceFile.empty() && readSourceFile(sourceFile, source)) {
+        setSource(source);
         compile();
     }
-    
-    delete[] source;
 }
 
 void Shader::loadSource(const std::string& sourceFile) {
-    const GLchar* source = nullptr;
-    if (source = readSourceFile(sourceFile)) {
-        glShaderSource(shaderID, 1, &source, NULL);
+    std::string source;
+    if (readSourceFile(sourceFile, source)) {
+        setSource(source);
+    }
+}
+
+void Shader::setSource(const std::string& source) {
+    // The shaders only use OpenGL 4.5 features, so they are lowered rather than rejected
+    // on 4.5 contexts
+    size_t directive = source.find(OPEN_GL_VERSION);
+    if (directive != std::string::npos && !isGlsl460Supported()) {
+        std::string lowered = source;
+        lowered.replace(directive, std::strlen(OPEN_GL_VERSION), OPEN_GL_FALLBACK_VERSION);
+
+        const GLchar* text = lowered.c_str();
+        glShaderSource(shader.get(), 1, &text, NULL);
+        return;
     }
-    delete[] source;
+
+    const GLchar* text = source.c_str();
+    glShaderSource(shader.get(), 1, &text, NULL);
 }
 
 void Shader::compile() {
+    startCompile();
+    checkCompile();
+}
+
+void Shader::startCompile() {
+    glCompileShader(shader.get());
+}
+
+bool Shader::checkCompile() const {
     GLint success;
     GLchar log[512];
     
-    // Attempt to compile the shader
-    glCompileShader(shaderID);
-    
     // Check for compilation errors
-    glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(shader.get(), GL_COMPILE_STATUS, &success);
     if (!success) {
-        glGetShaderInfoLog(shaderID, 512, NULL, log);
+        glGetShaderInfoLog(shader.get(), 512, NULL, log);
         std::cerr << "Shader compilation failed:\n" << log << std::endl;
     }
-}
-
 
-Shader::~Shader() {
-    glDeleteShader(shaderID);
+    return success;
 }
 
 
-
-/*****************************************/
-/*            Private Methods            */
-/*****************************************/
-
-
-const GLchar* Shader::readSourceFile(const std::string& sourceFile) {
+bool Shader::readSourceFile(const std::string& sourceFile, std::string& source) {
     // Open the file in binary mode at the end to determine size
-    std::ifstream source(sourceFile, std::ios::binary | std::ios::ate);
-    if (!source.is_open()) {
+    std::ifstream file(sourceFile, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
         std::cerr << "Error: Failed to open file '" << sourceFile << "'. Please check if the file exists and you have read permissions." << std::endl;
-        return nullptr;
+        return false;
     }
     
-    // Get the file size and allocate a buffer
-    size_t size = source.tellg(); // Get the shader file size
-    source.seekg(0, std::ios::beg); // Set stream position to beginning of file
-    GLchar* buffer = new char[size + 1];
+    // Get the file size and allocate the string
+    size_t size = file.tellg(); // Get the shader file size
+    file.seekg(0, std::ios::beg); // Set stream position to beginning of file
+    source.resize(size);
     
-    // Read the entire file into the buffer
-    source.read(buffer, size);
-    buffer[size] = '\0'; // Null-terminate the string
-    source.close();
+    // Read the entire file into the string
+    file.read(source.data(), size);
+    file.close();
     
-    return buffer;
-}
\ No newline at end of file
+    return true;
+}
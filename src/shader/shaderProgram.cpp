@@ -1,100 +1,275 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <iostream>
+#include <string>
 
 #include "shader/shaderProgram.hpp"
+#include "shader/programCache.hpp"
 
 ShaderProgram::ShaderProgram() {
-    programID = glCreateProgram();
+    program = GlProgram::create();
 }
 
 ShaderProgram::ShaderProgram(const Shader& vertShader, const Shader& fragShader) {
-    programID = glCreateProgram();
+    program = GlProgram::create();
     addShader(vertShader);
     addShader(fragShader);
     link();
 }
 
-ShaderProgram::ShaderProgram(const std::string& vertShaderPath, const std::string& fragShaderPath) {
-    // create shaders
-    Shader vertShader = Shader(vertex, vertShaderPath);
-    Shader fragShader = Shader(fragment, fragShaderPath);
+ShaderProgram::ShaderProgram(const std::string& vertShaderPath, const std::string& fragShaderPath, bool deferred)
+    : stage(BuildStage::Pending), vertShaderPath(vertShaderPath), fragShaderPath(fragShaderPath) {
+    program = GlProgram::create();
 
-    programID = glCreateProgram();
-    addShader(vertShader);
-    addShader(fragShader);
-    link();
-
-    // shaders are deleted since Shader class destructor deletes them
+    if (!deferred) build();
 }
 
 void ShaderProgram::addShader(const Shader& shader) {
-    glAttachShader(programID, shader.getShaderID());
+    glAttachShader(program.get(), shader.getShaderID());
 }
 
 void ShaderProgram::removeShader(GLuint shaderID) {
-    glDetachShader(programID, shaderID);
+    glDetachShader(program.get(), shaderID);
 }
 
 void ShaderProgram::use() {
+    // A deferred program is finished on first use rather than drawn unlinked
+    if (!isReady()) build();
+
     int success;
     char log[512];
 
-    glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    glGetProgramiv(program.get(), GL_LINK_STATUS, &success);
     if (!success) {
-        glGetProgramInfoLog(programID, 512, NULL, log);
+        glGetProgramInfoLog(program.get(), 512, NULL, log);
         std::cerr << "ERROR::SHADER::PROGRAM::NOT_LINKED\n" << log << std::endl;
         return;
     }
 
-    glUseProgram(programID);
+    glUseProgram(program.get());
 }
 
 void ShaderProgram::link() {
-    glLinkProgram(programID);
-
-    int success;
-    char log[512];
+    glLinkProgram(program.get());
+    finishLink();
+}
 
-    glGetProgramiv(programID, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(programID, 512, NULL, log);
-        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << log << std::endl;
+void ShaderProgram::build() {
+    while (!isReady()) {
+        buildStep(true);
     }
 }
 
-GLuint ShaderProgram::ID() const { return programID; }
+bool ShaderProgram::poll() {
+    if (!isReady()) buildStep(false);
+    return isReady();
+}
+
+GLuint ShaderProgram::ID() const { return program.get(); }
+
+void ShaderProgram::setUniform(UniformId id, GLint value) {
+    glUniform1i(getUniformLocation(id), value);
+}
+
+void ShaderProgram::setUniform(UniformId id, GLuint value) {
+    glUniform1i(getUniformLocation(id), value);
+}
+
+void ShaderProgram::setUniform(UniformId id, GLfloat value) {
+    glUniform1f(getUniformLocation(id), value);
+}
 
-void ShaderProgram::setUniform(const std::string& name, GLint value) {
-    glUniform1i(glGetUniformLocation(programID, name.c_str()), value);
+void ShaderProgram::setUniform(UniformId id, const glm::vec2& value) {
+    glUniform2fv(getUniformLocation(id), 1, &value[0]);
 }
 
-void ShaderProgram::setUniform(const std::string& name, GLuint value) {
-    glUniform1i(glGetUniformLocation(programID, name.c_str()), value);
+void ShaderProgram::setUniform(UniformId id, const glm::vec3& value) {
+    glUniform3fv(getUniformLocation(id), 1, &value[0]);
 }
 
-void ShaderProgram::setUniform(const std::string& name, GLfloat value) {
-    glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
+void ShaderProgram::setUniform(UniformId id, const glm::vec4& value) {
+    glUniform4fv(getUniformLocation(id), 1, &value[0]);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec2& value) {
-    glUniform2fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
+void ShaderProgram::setUniform(UniformId id, const glm::mat3& value) {
+    glUniformMatrix3fv(getUniformLocation(id), 1, GL_FALSE, &value[0][0]);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec3& value) {
-    glUniform3fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
+void ShaderProgram::setUniform(UniformId id, const glm::mat4& value) {
+    glUniformMatrix4fv(getUniformLocation(id), 1, GL_FALSE, &value[0][0]);
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::vec4& value) {
-    glUniform4fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
+void ShaderProgram::buildStep(bool wait) {
+    auto start = std::chrono::steady_clock::now();
+
+    switch (stage) {
+    case BuildStage::Pending: {
+        std::string vertSource, fragSource;
+        Shader::readSourceFile(vertShaderPath, vertSource);
+        Shader::readSourceFile(fragShaderPath, fragSource);
+
+        cacheSupported = ProgramCache::isSupported();
+        cacheKey = cacheSupported ? ProgramCache::getKey({ vertSource, fragSource }) : 0;
+
+        double coldBuildTime = 0.0;
+        if (cacheSupported && ProgramCache::read(cacheKey, program.get(), coldBuildTime)) {
+            reflectUniforms();
+            fromBinaryCache = true;
+            stage = BuildStage::Ready;
+            buildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            savedTime = std::max(coldBuildTime - buildTime, 0.0);
+            return;
+        }
+
+        vertShader = std::make_unique<Shader>(vertex);
+        vertShader->setSource(vertSource);
+        fragShader = std::make_unique<Shader>(fragment);
+        fragShader->setSource(fragSource);
+
+        if (hasParallelCompile()) {
+            // Everything is submitted at once, the driver works while frames are drawn
+            vertShader->startCompile();
+            fragShader->startCompile();
+            addShader(*vertShader);
+            addShader(*fragShader);
+            if (cacheSupported) glProgramParameteri(program.get(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(program.get());
+            stage = BuildStage::Linking;
+        } else {
+            stage = BuildStage::CompilingVertex;
+        }
+        break;
+    }
+
+    case BuildStage::CompilingVertex:
+        vertShader->compile();
+        stage = BuildStage::CompilingFragment;
+        break;
+
+    case BuildStage::CompilingFragment:
+        fragShader->compile();
+        addShader(*vertShader);
+        addShader(*fragShader);
+        if (cacheSupported) glProgramParameteri(program.get(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program.get());
+        stage = BuildStage::Linking;
+        break;
+
+    case BuildStage::Linking: {
+        if (hasParallelCompile() && !wait) {
+            GLint completed = GL_FALSE;
+            glGetProgramiv(program.get(), GL_COMPLETION_STATUS_KHR, &completed);
+            if (!completed) break;
+        }
+
+        // Compile errors were not checked when the shaders were submitted in parallel
+        if (hasParallelCompile()) {
+            vertShader->checkCompile();
+            fragShader->checkCompile();
+        }
+
+        bool linked = finishLink();
+        stage = linked ? BuildStage::Ready : BuildStage::Failed;
+
+        // The program keeps its own copy of the linked code
+        vertShader.reset();
+        fragShader.reset();
+
+        buildTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (linked && cacheSupported) ProgramCache::write(cacheKey, program.get(), buildTime);
+        return;
+    }
+
+    case BuildStage::Ready:
+    case BuildStage::Failed:
+        return;
+    }
+
+    buildTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat3& value) {
-    glUniformMatrix3fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+bool ShaderProgram::finishLink() {
+    int success;
+    char log[512];
+
+    glGetProgramiv(program.get(), GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program.get(), 512, NULL, log);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << log << std::endl;
+        uniformTable.clear();
+        uniformMask = 0;
+        return false;
+    }
+
+    reflectUniforms();
+    return true;
 }
 
-void ShaderProgram::setUniform(const std::string& name, const glm::mat4& value) {
-    glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+void ShaderProgram::reflectUniforms() {
+    GLint activeCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(program.get(), GL_ACTIVE_UNIFORMS, &activeCount);
+    glGetProgramiv(program.get(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    // Gather every name first, arrays expand to one entry per element
+    std::vector<std::pair<UniformId, GLint>> uniforms;
+    std::string name((size_t) std::max(maxNameLength, 1), '\0');
+
+    for (GLint i = 0; i < activeCount; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program.get(), (GLuint) i, (GLsizei) name.size(), &length, &size, &type, name.data());
+
+        std::string_view uniformName(name.data(), (size_t) length);
+        GLint location = glGetUniformLocation(program.get(), name.c_str());
+
+        // Members of uniform blocks have no location
+        if (location < 0) continue;
+
+        size_t bracket = uniformName.find('[');
+        if (bracket == std::string_view::npos) {
+            uniforms.push_back({ hashString(uniformName), location });
+            continue;
+        }
+
+        // Reported as "name[0]" followed by an optional member, element locations are not always contiguous
+        std::string_view prefix = uniformName.substr(0, bracket + 1);
+        std::string_view suffix = uniformName.substr(uniformName.find(']', bracket));
+        if (suffix == "]") uniforms.push_back({ hashString(uniformName.substr(0, bracket)), location });
+
+        for (GLint element = 0; element < size; element++) {
+            std::string elementName = std::string(prefix) + std::to_string(element) + std::string(suffix);
+            GLint elementLocation = glGetUniformLocation(program.get(), elementName.c_str());
+            if (elementLocation >= 0) uniforms.push_back({ uniformId(prefix, (size_t) element, suffix), elementLocation });
+        }
+    }
+
+    // Keep the load factor at or below one half so probes stay short
+    size_t capacity = std::bit_ceil(std::max<size_t>(uniforms.size() * 2, 8));
+    uniformTable.assign(capacity, UniformSlot());
+    uniformMask = capacity - 1;
+
+    for (const auto& [id, location] : uniforms) {
+        size_t slot = (size_t) id & uniformMask;
+        while (uniformTable[slot].id != 0 && uniformTable[slot].id != id) {
+            slot = (slot + 1) & uniformMask;
+        }
+
+        uniformTable[slot] = { id, location };
+    }
 }
 
-ShaderProgram::~ShaderProgram() {
-    glDeleteProgram(programID);
+GLint ShaderProgram::getUniformLocation(UniformId id) const {
+    if (uniformTable.empty()) return -1;
+
+    size_t slot = (size_t) id & uniformMask;
+    while (uniformTable[slot].id != 0) {
+        if (uniformTable[slot].id == id) return uniformTable[slot].location;
+        slot = (slot + 1) & uniformMask;
+    }
+
+    // Not an active uniform, GL ignores location -1
+    return -1;
 }
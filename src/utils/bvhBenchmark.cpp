@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/bvhBenchmark.hpp"
+#include "UIHandler.hpp"
+#include "rendering/model.hpp"
+#include "utils/constants.hpp"
+
+
+int runBvhBenchmark(const ModelSettings& modelSettings) {
+    const std::string benchmarkModels[] = { "Head", "Triceratops" };
+
+    // Lean models have no hierarchy to measure
+    ModelSettings settings = modelSettings;
+    settings.leanResidency = false;
+    size_t mismatches = 0;
+
+    for (int i = 0; i < (int) std::size(ModelSelection::models); i++) {
+        std::string name = ModelSelection::models[i];
+        if (std::find(std::begin(benchmarkModels), std::end(benchmarkModels), name) == std::end(benchmarkModels)) continue;
+
+        Model model(UIHandler::getModelPath(i), settings, nullptr);
+        const Bvh& bvh = model.getBvh();
+
+        if (bvh.empty()) {
+            std::cerr << name << ": no triangles to cast rays against" << std::endl;
+            continue;
+        }
+
+        // Rays start on a sphere around the model and aim at random points of its bounding sphere
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        auto randomInBall = [&]() {
+            glm::vec3 point;
+            do {
+                point = glm::vec3(unit(random), unit(random), unit(random));
+            } while (glm::length(point) > 1.0f || glm::length(point) == 0.0f);
+            return point;
+        };
+
+        std::vector<glm::vec3> origins(BVH_BENCHMARK_RAYS);
+        std::vector<glm::vec3> directions(BVH_BENCHMARK_RAYS);
+        glm::vec3 center = model.getModelCenter();
+        float radius = model.getModelRadius();
+
+        for (size_t r = 0; r < BVH_BENCHMARK_RAYS; r++) {
+            origins[r] = center + glm::normalize(randomInBall()) * radius * 2.0f;
+            directions[r] = glm::normalize(center + randomInBall() * radius - origins[r]);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t hits = 0;
+        for (size_t r = 0; r < BVH_BENCHMARK_RAYS; r++) {
+            hits += bvh.intersect(origins[r], directions[r]).hit;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t modelMismatches = 0;
+        for (size_t r = 0; r < BVH_BENCHMARK_CHECKED_RAYS && r < BVH_BENCHMARK_RAYS; r++) {
+            RayHit fast = bvh.intersect(origins[r], directions[r]);
+            RayHit reference = bvh.intersectBruteForce(origins[r], directions[r]);
+
+            if (fast.hit != reference.hit || (fast.hit && std::abs(fast.distance - reference.distance) > 1e-5f * radius)) {
+                modelMismatches++;
+            }
+        }
+        mismatches += modelMismatches;
+
+        std::cout << name << ": " << bvh.getTriangleCount() << " triangles, " << bvh.getNodeCount() << " nodes ("
+                  << bvh.getMemoryBytes() / (1024.0 * 1024.0) << " MB), built in " << model.getBvhBuildTime() << " ms" << std::endl;
+        std::cout << "  " << BVH_BENCHMARK_RAYS << " rays in " << seconds * 1000.0 << " ms: " 
+                  << BVH_BENCHMARK_RAYS / seconds / 1e6 << " M rays/s, " << 100.0 * hits / BVH_BENCHMARK_RAYS << "% hits, "
+                  << modelMismatches << " of " << BVH_BENCHMARK_CHECKED_RAYS << " checked rays differ from brute force" << std::endl;
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
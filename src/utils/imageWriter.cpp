@@ -0,0 +1,28 @@
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <stb_include/stb_image_write.h>
+
+#include "utils/imageWriter.hpp"
+
+
+bool writePng(const std::string& path, const unsigned char* pixels, int width, int height, bool bottomUp) {
+    size_t rowBytes = (size_t) width * 4;
+    std::vector<unsigned char> flipped;
+
+    // stb's own flip is a global setting, so the rows are reordered in a private copy instead
+    if (bottomUp) {
+        flipped.resize(rowBytes * height);
+        for (int row = 0; row < height; row++) {
+            std::memcpy(flipped.data() + row * rowBytes, pixels + (size_t) (height - 1 - row) * rowBytes, rowBytes);
+        }
+        pixels = flipped.data();
+    }
+
+    if (!stbi_write_png(path.c_str(), width, height, 4, pixels, (int) rowBytes)) {
+        std::cerr << "Failed to write image " << path << std::endl;
+        return false;
+    }
+
+    return true;
+}
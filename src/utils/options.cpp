@@ -0,0 +1,108 @@
+#include <charconv>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "utils/options.hpp"
+
+
+/**
+ * @brief Looks up an import profile by its command line name
+ * 
+ * @param name The profile name
+ * @param profile Set to the matching profile if found
+ * @return True if the name is a known profile
+ */
+static bool parseImportProfile(const std::string& name, ImportProfile& profile) {
+    for (int i = 0; i < (int) std::size(ImportProfileSelection::names); i++) {
+        if (name == ImportProfileSelection::names[i]) {
+            profile = static_cast<ImportProfile>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Parses a frame count
+ * 
+ * @param value The command line value
+ * @param frames Set to the count if the value is a positive integer
+ * @return True if the value is valid
+ */
+static bool parseFrameCount(const std::string& value, int& frames) {
+    int count = 0;
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+
+    if (error != std::errc() || end != value.data() + value.size() || count <= 0) {
+        std::cerr << "Invalid frame count: " << value << " (expected a positive integer)" << std::endl;
+        return false;
+    }
+
+    frames = count;
+    return true;
+}
+
+Options parseOptions(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--import-profile=", 0) == 0) {
+            std::string value = arg.substr(arg.find('=') + 1);
+
+            if (!parseImportProfile(value, options.modelSettings.importProfile)) {
+                std::cerr << "Unknown import profile: " << value << " (expected fast, optimized or max-quality)" << std::endl;
+            }
+        } else if (arg == "--lean") {
+            options.modelSettings.leanResidency = true;
+        } else if (arg == "--no-mesh-optimizer") {
+            options.modelSettings.meshOptimization = false;
+        } else if (arg == "--packed-vertices") {
+            options.modelSettings.packedVertices = true;
+        } else if (arg == "--split-indices") {
+            options.modelSettings.splitIndexBuffers = true;
+        } else if (arg == "--no-lods") {
+            options.modelSettings.generateLods = false;
+        } else if (arg == "--bvh-benchmark") {
+            options.bvhBenchmark = true;
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            parseFrameCount(arg.substr(arg.find('=') + 1), options.headlessFrames);
+        } else if (arg == "--batch") {
+            options.batch = true;
+        } else if (arg.rfind("--batch=", 0) == 0) {
+            options.batch = true;
+            options.batchJobs = arg.substr(arg.find('=') + 1);
+        } else if (arg.rfind("--batch-output=", 0) == 0) {
+            options.batchOutput = arg.substr(arg.find('=') + 1);
+        } else if (arg.rfind("--capture=", 0) == 0) {
+            std::string value = arg.substr(arg.find('=') + 1);
+
+            if (value == "turntable") {
+                options.capture = CaptureMode::TURNTABLE;
+            } else if (value == "orbit") {
+                options.capture = CaptureMode::ORBIT;
+            } else {
+                std::cerr << "Unknown capture mode: " << value << " (expected turntable or orbit)" << std::endl;
+            }
+        } else if (arg.rfind("--capture-frames=", 0) == 0) {
+            parseFrameCount(arg.substr(arg.find('=') + 1), options.captureFrames);
+        } else if (arg.rfind("--capture-output=", 0) == 0) {
+            options.captureOutput = arg.substr(arg.find('=') + 1);
+        } else if (arg == "--benchmark") {
+            options.benchmark = true;
+        } else if (arg.rfind("--benchmark-frames=", 0) == 0) {
+            parseFrameCount(arg.substr(arg.find('=') + 1), options.benchmarkFrames);
+        } else if (arg.rfind("--benchmark-output=", 0) == 0) {
+            options.benchmarkOutput = arg.substr(arg.find('=') + 1);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+        }
+    }
+
+    return options;
+}
@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <SDL2/SDL.h>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "config.h"
+#include "camera.hpp"
+#include "window.hpp"
+#include "UIHandler.hpp"
+#include "utils/renderBenchmark.hpp"
+#include "utils/constants.hpp"
+#include "rendering/gpuResource.hpp"
+#include "rendering/gpuTimer.hpp"
+#include "rendering/model.hpp"
+#include "rendering/renderQueue.hpp"
+#include "rendering/textureCache.hpp"
+#include "shader/shaderProgram.hpp"
+#include "lighting/lighting.hpp"
+
+
+/**
+ * @brief Draws one frame of the main render loop, without UI
+ *
+ * @param model The model to draw
+ * @param shader The shader the model is drawn with
+ * @param worldGridShader The shader of the world grid
+ * @param worldGridVao The empty vertex array the grid is drawn with
+ * @param camera The camera the frame is seen from
+ * @param lighting The lighting of the model
+ * @param renderQueue The queue sorting the mesh draws
+ * @param viewportHeight Height of the viewport in pixels
+ */
+static void renderFrame(Model& model, ShaderProgram& shader, ShaderProgram& worldGridShader, GLuint worldGridVao,
+                        const Camera& camera, Lighting& lighting, RenderQueue& renderQueue, float viewportHeight) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glm::mat4 view = camera.getViewMatrix();
+    glm::mat4 projection = camera.getProjectionMatrix();
+
+    lighting.setView(view);
+    lighting.setProjection(projection);
+    lighting.updateUniformBuffer();
+
+    shader.use();
+    model.updateNormalMatrix(view);
+    shader.setUniform("view"_uniform, view);
+    shader.setUniform("projection"_uniform, projection);
+    shader.setUniform("model"_uniform, model.getModelMatrix());
+    shader.setUniform("normalMatrix"_uniform, model.getNormalMatrix());
+
+    model.cullMeshes(camera.getCameraPos(), view, projection, viewportHeight);
+    model.selectLods(camera.getCameraPos(), projection, viewportHeight);
+    model.draw(shader, renderQueue, view);
+    renderQueue.execute();
+
+    worldGridShader.use();
+    worldGridShader.setUniform("view"_uniform, view);
+    worldGridShader.setUniform("projection"_uniform, projection);
+    worldGridShader.setUniform("cameraPos"_uniform, camera.getCameraPos());
+    worldGridShader.setUniform("modelRadius"_uniform, model.getModelRadius());
+    glBindVertexArray(worldGridVao);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glDrawArrays(GL_LINES, 6, 2);
+}
+
+/**
+ * @brief Quotes a string for JSON
+ *
+ * @param text The string
+ * @return The string in quotes, with quotes, backslashes and control characters escaped
+ */
+static std::string quoteJson(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if ((unsigned char) c < 0x20) {
+            quoted += ' ';
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief Writes a frame time distribution as a JSON object
+ *
+ * @param out The stream to write to
+ * @param stats The distribution
+ */
+static void writeStatsJson(std::ofstream& out, const FrameTimeStats& stats) {
+    out << "{ \"p50\": " << stats.p50 << ", \"p95\": " << stats.p95 << ", \"p99\": " << stats.p99
+        << ", \"max\": " << stats.max << ", \"mean\": " << stats.mean << " }";
+}
+
+/**
+ * @brief Writes the benchmark report as JSON
+ *
+ * @param path Path of the JSON file
+ * @param runs The measured runs
+ * @param frames Frames measured per run
+ * @param width Width of the viewport in pixels
+ * @param height Height of the viewport in pixels
+ * @return True if the file was written
+ */
+static bool writeJsonReport(const std::string& path, const std::vector<BenchmarkRun>& runs, int frames, int width, int height) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open benchmark report " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    auto glString = [](GLenum name) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        return std::string(value ? value : "");
+    };
+
+    out << "{\n";
+    out << "  \"vendor\": " << quoteJson(glString(GL_VENDOR)) << ",\n";
+    out << "  \"renderer\": " << quoteJson(glString(GL_RENDERER)) << ",\n";
+    out << "  \"version\": " << quoteJson(glString(GL_VERSION)) << ",\n";
+    out << "  \"width\": " << width << ",\n";
+    out << "  \"height\": " << height << ",\n";
+    out << "  \"warmupFrames\": " << BENCHMARK_WARMUP_FRAMES << ",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"timestepMs\": " << BENCHMARK_TIMESTEP_MS << ",\n";
+    out << "  \"runs\": [\n";
+
+    for (size_t i = 0; i < runs.size(); i++) {
+        const BenchmarkRun& run = runs[i];
+        out << "    { \"model\": " << quoteJson(ModelSelection::models[run.model])
+            << ", \"shader\": " << quoteJson(ShaderSelection::shaders[run.shader])
+            << ", \"frames\": " << run.frames << ",\n      \"cpuMs\": ";
+        writeStatsJson(out, run.cpu);
+        out << ",\n      \"gpuMs\": ";
+        writeStatsJson(out, run.gpu);
+        out << " }" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n";
+    out.close();
+    return (bool) out;
+}
+
+/**
+ * @brief Writes the benchmark report as CSV, one row per model and shader
+ *
+ * @param path Path of the CSV file
+ * @param runs The measured runs
+ * @return True if the file was written
+ */
+static bool writeCsvReport(const std::string& path, const std::vector<BenchmarkRun>& runs) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Failed to open benchmark report " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    out << "model,shader,frames,cpu_p50_ms,cpu_p95_ms,cpu_p99_ms,cpu_max_ms,cpu_mean_ms,gpu_p50_ms,gpu_p95_ms,gpu_p99_ms,gpu_max_ms,gpu_mean_ms\n";
+    for (const BenchmarkRun& run : runs) {
+        out << ModelSelection::models[run.model] << "," << ShaderSelection::shaders[run.shader] << "," << run.frames;
+        for (const FrameTimeStats* stats : { &run.cpu, &run.gpu }) {
+            out << "," << stats->p50 << "," << stats->p95 << "," << stats->p99 << "," << stats->max << "," << stats->mean;
+        }
+        out << "\n";
+    }
+
+    out.close();
+    return (bool) out;
+}
+
+FrameTimeStats getFrameTimeStats(std::vector<double>& times) {
+    FrameTimeStats stats;
+    if (times.empty()) return stats;
+
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&](double p) {
+        size_t rank = (size_t) std::ceil(p / 100.0 * times.size());
+        return times[std::clamp<size_t>(rank, 1, times.size()) - 1];
+    };
+
+    double total = 0.0;
+    for (double time : times) total += time;
+
+    stats.p50 = percentile(50.0);
+    stats.p95 = percentile(95.0);
+    stats.p99 = percentile(99.0);
+    stats.max = times.back();
+    stats.mean = total / times.size();
+    return stats;
+}
+
+int runRenderBenchmark(const Options& options) {
+    Window window(options.headless, false);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    std::vector<BenchmarkRun> runs;
+    bool interrupted = false;
+    const float timestep = BENCHMARK_TIMESTEP_MS;
+
+    {
+        // Each program is built before its runs, so compilation is never measured
+        std::unique_ptr<ShaderProgram> shaders[std::size(ShaderSelection::shaders)];
+        for (int i = 0; i < (int) std::size(shaders); i++) {
+            shaders[i] = std::make_unique<ShaderProgram>(std::string(ASSETS_PATH) + "shaders/" + ShaderSelection::vertexFiles[i],
+                                                         std::string(ASSETS_PATH) + "shaders/" + ShaderSelection::fragmentFiles[i], true);
+        }
+        ShaderProgram worldGridShader(std::string(ASSETS_PATH) + "shaders/worldGrid.vert", std::string(ASSETS_PATH) + "shaders/worldGrid.frag");
+        GlVertexArray worldGridVao = GlVertexArray::create();
+
+        Lighting lighting;
+        RenderQueue renderQueue;
+        GpuTimer frameTimer(BENCHMARK_TIMER_QUERIES);
+
+        for (int m = 0; m < (int) std::size(ModelSelection::models) && !interrupted; m++) {
+            std::unique_ptr<Model> model = std::make_unique<Model>(UIHandler::getModelPath(m), options.modelSettings);
+            lighting.setModel(model.get());
+
+            for (int s = 0; s < (int) std::size(shaders) && !interrupted; s++) {
+                shaders[s]->build();
+
+                // Every run starts from the same pose
+                model->resetModel();
+                Camera camera(model->getModelRadius(), model->getModelCenter());
+                lighting.setCamera(&camera);
+
+                std::vector<double> cpuTimes;
+                std::vector<double> gpuTimes;
+                cpuTimes.reserve(options.benchmarkFrames);
+                gpuTimes.reserve(options.benchmarkFrames);
+                int timedFrames = 0;
+
+                auto takeGpuTimes = [&]() {
+                    double gpuTime = 0.0;
+                    while (frameTimer.takeResult(gpuTime)) {
+                        if (timedFrames++ >= BENCHMARK_WARMUP_FRAMES) gpuTimes.push_back(gpuTime);
+                    }
+                };
+
+                for (int frame = 0; frame < BENCHMARK_WARMUP_FRAMES + options.benchmarkFrames; frame++) {
+                    // Keep the window responsive, closing it ends the benchmark
+                    if (!window.isHeadless()) {
+                        SDL_Event event;
+                        while (SDL_PollEvent(&event) > 0) {
+                            if (event.type == SDL_QUIT) interrupted = true;
+                        }
+                        if (interrupted) break;
+                    }
+
+                    auto frameStart = std::chrono::steady_clock::now();
+
+                    frameTimer.begin();
+                    renderFrame(*model, *shaders[s], worldGridShader, worldGridVao.get(), camera, lighting, renderQueue, (float) viewport[3]);
+                    frameTimer.end();
+                    window.swapWindow();
+
+                    double cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+                    if (frame >= BENCHMARK_WARMUP_FRAMES) cpuTimes.push_back(cpuTime);
+
+                    frameTimer.update();
+                    takeGpuTimes();
+
+                    model->rotate(BENCHMARK_ROTATION_SPEED * timestep / 1000.0f, DEFAULT_ROTATION_AXIS);
+                    camera.orbit(model->getModelCenter(), BENCHMARK_ORBIT_SPEED * timestep / 1000.0f);
+                }
+
+                frameTimer.finish();
+                takeGpuTimes();
+                if (interrupted) break;
+
+                BenchmarkRun run = { m, s, cpuTimes.size(), getFrameTimeStats(cpuTimes), getFrameTimeStats(gpuTimes) };
+                runs.push_back(run);
+
+                std::cout << ModelSelection::models[m] << " / " << ShaderSelection::shaders[s]
+                          << ": CPU p50 " << run.cpu.p50 << " ms, p99 " << run.cpu.p99 << " ms | GPU p50 " << run.gpu.p50
+                          << " ms, p99 " << run.gpu.p99 << " ms" << std::endl;
+            }
+
+            lighting.setCamera(nullptr);
+            lighting.setModel(nullptr);
+        }
+
+        lighting.cleanup();
+        TextureCache::getShared().clear();
+    }
+
+    int result = 1;
+    if (interrupted) {
+        std::cerr << "Benchmark interrupted, no report written" << std::endl;
+    } else {
+        std::string jsonPath = options.benchmarkOutput + ".json";
+        std::string csvPath = options.benchmarkOutput + ".csv";
+
+        std::error_code error;
+        std::filesystem::path directory = std::filesystem::path(jsonPath).parent_path();
+        if (!directory.empty()) std::filesystem::create_directories(directory, error);
+
+        if (writeJsonReport(jsonPath, runs, options.benchmarkFrames, viewport[2], viewport[3]) && writeCsvReport(csvPath, runs)) {
+            std::cout << "Benchmark: " << runs.size() << " runs of " << options.benchmarkFrames << " frames written to "
+                      << jsonPath << " and " << csvPath << std::endl;
+            result = 0;
+        }
+    }
+
+    window.closeWindow();
+
+    return result;
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+
+#include "utils/threadPool.hpp"
+
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = 1;
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::getShared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& function) {
+    if (count == 0) return;
+
+    struct Work {
+        std::atomic<size_t> next = 0;   // Next index to hand out
+        size_t done = 0;                // Number of indices completed
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    auto work = std::make_shared<Work>();
+
+    // Pulls indices until none are left, shared by the helpers and the caller
+    auto run = [work, count, &function]() {
+        size_t completed = 0;
+        for (size_t i = work->next++; i < count; i = work->next++) {
+            function(i);
+            completed++;
+        }
+
+        if (completed > 0) {
+            std::lock_guard<std::mutex> lock(work->mutex);
+            work->done += completed;
+            if (work->done == count) work->finished.notify_all();
+        }
+    };
+
+    // Helpers that start after all indices were taken exit immediately without touching function
+    size_t helpers = std::min(workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; i++) {
+        submit(run);
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(work->mutex);
+    work->finished.wait(lock, [&]() { return work->done == count; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+            if (stopping && tasks.empty()) return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        task();
+    }
+}
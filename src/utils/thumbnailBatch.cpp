@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "config.h"
+#include "window.hpp"
+#include "UIHandler.hpp"
+#include "utils/thumbnailBatch.hpp"
+#include "utils/threadPool.hpp"
+#include "utils/imageWriter.hpp"
+#include "utils/constants.hpp"
+#include "rendering/model.hpp"
+#include "rendering/renderQueue.hpp"
+#include "rendering/renderTarget.hpp"
+#include "rendering/textureCache.hpp"
+#include "shader/shaderProgram.hpp"
+#include "lighting/lighting.hpp"
+
+
+/**
+ * @brief Removes the blanks around a field
+ *
+ * @param text The field
+ * @return The field without leading and trailing whitespace
+ */
+static std::string_view trim(std::string_view text) {
+    while (!text.empty() && std::isspace((unsigned char) text.front())) text.remove_prefix(1);
+    while (!text.empty() && std::isspace((unsigned char) text.back())) text.remove_suffix(1);
+    return text;
+}
+
+/**
+ * @brief Looks up a name in a selection list, ignoring case
+ *
+ * @param name The name to look up, or `*`
+ * @param names The selection list
+ * @param indices Receives the matching index, or every index for `*`
+ * @return True if the name matched
+ */
+template <size_t N>
+static bool findSelection(std::string_view name, const char* const (&names)[N], std::vector<int>& indices) {
+    if (name == "*") {
+        for (int i = 0; i < (int) N; i++) indices.push_back(i);
+        return true;
+    }
+
+    for (int i = 0; i < (int) N; i++) {
+        std::string_view candidate = names[i];
+        if (candidate.size() == name.size() && std::equal(candidate.begin(), candidate.end(), name.begin(),
+                [](char a, char b) { return std::tolower((unsigned char) a) == std::tolower((unsigned char) b); })) {
+            indices.push_back(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Parses a whole field as a number
+ *
+ * @param text The field
+ * @param value Set to the number on success
+ * @return True if the field is a number and nothing else
+ */
+template <typename T>
+static bool parseNumber(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+/**
+ * @brief Builds the file name of a job's image
+ *
+ * @param job The job
+ * @return File name such as `Space-Shuttle_Phong_45_20_256x256.png`
+ */
+static std::string getThumbnailName(const ThumbnailJob& job) {
+    std::string name = std::string(ModelSelection::models[job.model]) + "_" + ShaderSelection::shaders[job.shader];
+    std::replace(name.begin(), name.end(), ' ', '-');
+
+    char suffix[64];
+    std::snprintf(suffix, sizeof(suffix), "_%g_%g_%dx%d.png", job.yaw, job.pitch, job.width, job.height);
+    return name + suffix;
+}
+
+/**
+ * @brief Draws one job into the bound render target
+ *
+ * The camera orbits the model's center at the distance fitting its bounding sphere in both
+ * fields of view, so every angle and aspect ratio frames the whole model.
+ *
+ * @param job The job to draw
+ * @param model The uploaded model of the job
+ * @param shader The shader of the job
+ * @param lighting The lighting shared by every job
+ * @param renderQueue The queue sorting the mesh draws
+ */
+static void renderThumbnail(const ThumbnailJob& job, Model& model, ShaderProgram& shader, Lighting& lighting, RenderQueue& renderQueue) {
+    float aspectRatio = (float) job.width / (float) job.height;
+    float halfFov = glm::radians(DEFAULT_CAMERA_FOV) / 2.0f;
+    float halfHorizontalFov = std::atan(std::tan(halfFov) * aspectRatio);
+    float distance = model.getModelRadius() / std::sin(std::min(halfFov, halfHorizontalFov));
+
+    float yaw = glm::radians(job.yaw);
+    float pitch = glm::radians(job.pitch);
+    glm::vec3 center = model.getModelCenter();
+    glm::vec3 cameraPos = center + distance * glm::vec3(std::cos(pitch) * std::sin(yaw), std::sin(pitch), std::cos(pitch) * std::cos(yaw));
+
+    glm::mat4 view = glm::lookAt(cameraPos, center, DEFAULT_GLOBAL_UP);
+    glm::mat4 projection = glm::perspective(2.0f * halfFov, aspectRatio, DEFAULT_NEAR_CLIPPING_PLANE, DEFAULT_FAR_CLIPPING_PLANE);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    lighting.setView(view);
+    lighting.setProjection(projection);
+    lighting.updateUniformBuffer();
+
+    shader.use();
+    model.updateNormalMatrix(view);
+    shader.setUniform("view"_uniform, view);
+    shader.setUniform("projection"_uniform, projection);
+    shader.setUniform("model"_uniform, model.getModelMatrix());
+    shader.setUniform("normalMatrix"_uniform, model.getNormalMatrix());
+
+    model.cullMeshes(cameraPos, view, projection, (float) job.height);
+    model.selectLods(cameraPos, projection, (float) job.height);
+    model.draw(shader, renderQueue, view);
+    renderQueue.execute();
+}
+
+bool readThumbnailJobs(const std::string& path, std::vector<ThumbnailJob>& jobs) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Failed to open thumbnail job list '" << path << "'" << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+
+        std::string_view text = trim(line);
+        if (text.empty() || text.front() == '#') continue;
+
+        std::vector<std::string_view> fields;
+        size_t start = 0;
+        while (true) {
+            size_t comma = text.find(',', start);
+            fields.push_back(trim(text.substr(start, comma - start)));
+            if (comma == std::string_view::npos) break;
+            start = comma + 1;
+        }
+
+        std::vector<int> models;
+        std::vector<int> shaders;
+        ThumbnailJob job = {};
+
+        if (fields.size() != 6) {
+            std::cerr << path << ":" << lineNumber << ": expected model, shader, yaw, pitch, width, height" << std::endl;
+            continue;
+        }
+        if (!findSelection(fields[0], ModelSelection::models, models)) {
+            std::cerr << path << ":" << lineNumber << ": unknown model " << fields[0] << std::endl;
+            continue;
+        }
+        if (!findSelection(fields[1], ShaderSelection::shaders, shaders)) {
+            std::cerr << path << ":" << lineNumber << ": unknown shader " << fields[1] << std::endl;
+            continue;
+        }
+        if (!parseNumber(fields[2], job.yaw) || !parseNumber(fields[3], job.pitch)) {
+            std::cerr << path << ":" << lineNumber << ": invalid camera angle" << std::endl;
+            continue;
+        }
+        if (!parseNumber(fields[4], job.width) || !parseNumber(fields[5], job.height) ||
+            job.width <= 0 || job.height <= 0 || job.width > THUMBNAIL_MAX_SIZE || job.height > THUMBNAIL_MAX_SIZE) {
+            std::cerr << path << ":" << lineNumber << ": invalid resolution (expected 1 to " << THUMBNAIL_MAX_SIZE << " pixels)" << std::endl;
+            continue;
+        }
+
+        for (int model : models) {
+            for (int shader : shaders) {
+                job.model = model;
+                job.shader = shader;
+                jobs.push_back(job);
+            }
+        }
+    }
+
+    return true;
+}
+
+std::vector<ThumbnailJob> getCatalogueJobs() {
+    std::vector<ThumbnailJob> jobs;
+
+    for (int model = 0; model < (int) std::size(ModelSelection::models); model++) {
+        for (int shader = 0; shader < (int) std::size(ShaderSelection::shaders); shader++) {
+            jobs.push_back({ model, shader, THUMBNAIL_DEFAULT_YAW, THUMBNAIL_DEFAULT_PITCH, THUMBNAIL_DEFAULT_SIZE, THUMBNAIL_DEFAULT_SIZE });
+        }
+    }
+
+    return jobs;
+}
+
+int runThumbnailBatch(const Options& options) {
+    std::vector<ThumbnailJob> jobs;
+    if (options.batchJobs.empty()) {
+        jobs = getCatalogueJobs();
+    } else if (!readThumbnailJobs(options.batchJobs, jobs)) {
+        return 1;
+    }
+
+    if (jobs.empty()) {
+        std::cerr << "No thumbnail jobs to render" << std::endl;
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.batchOutput, error);
+    if (error) {
+        std::cerr << "Failed to create thumbnail directory " << options.batchOutput << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    // Grouped by model so each is loaded once, then by size to reallocate the target less often
+    std::stable_sort(jobs.begin(), jobs.end(), [](const ThumbnailJob& a, const ThumbnailJob& b) {
+        if (a.model != b.model) return a.model < b.model;
+        if (a.width != b.width) return a.width < b.width;
+        return a.height < b.height;
+    });
+
+    std::vector<int> models;
+    for (const ThumbnailJob& job : jobs) {
+        if (models.empty() || models.back() != job.model) models.push_back(job.model);
+    }
+
+    Window window(true);
+
+    ThreadPool& pool = ThreadPool::getShared();
+    size_t maxPendingImages = pool.getThreadCount() * THUMBNAIL_PENDING_IMAGES_PER_THREAD;
+    size_t failedImages = 0;
+    double loadWait = 0.0;
+    double encodeWait = 0.0;
+
+    auto milliseconds = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    auto batchStart = std::chrono::steady_clock::now();
+
+    {
+        // Built on first use, so shaders no job asks for are never compiled
+        std::unique_ptr<ShaderProgram> shaders[std::size(ShaderSelection::shaders)];
+        for (int i = 0; i < (int) std::size(shaders); i++) {
+            shaders[i] = std::make_unique<ShaderProgram>(std::string(ASSETS_PATH) + "shaders/" + ShaderSelection::vertexFiles[i],
+                                                         std::string(ASSETS_PATH) + "shaders/" + ShaderSelection::fragmentFiles[i], true);
+        }
+
+        Lighting lighting;
+        RenderQueue renderQueue;
+        RenderTarget target;
+        std::deque<std::future<bool>> pendingImages;
+
+        auto loadModel = [&](int index) {
+            std::string path = UIHandler::getModelPath(index);
+            ModelSettings settings = options.modelSettings;
+            return pool.submit([path, settings]() { return std::make_unique<Model>(path, settings, nullptr); });
+        };
+
+        std::future<std::unique_ptr<Model>> nextModel = loadModel(models.front());
+        auto job = jobs.begin();
+
+        for (size_t m = 0; m < models.size(); m++) {
+            auto waitStart = std::chrono::steady_clock::now();
+            std::unique_ptr<Model> model = nextModel.get();
+            loadWait += milliseconds(waitStart, std::chrono::steady_clock::now());
+
+            // The next model decodes on a worker while this one renders
+            if (m + 1 < models.size()) {
+                nextModel = loadModel(models[m + 1]);
+            }
+
+            model->upload();
+            lighting.setModel(model.get());
+
+            for (; job != jobs.end() && job->model == models[m]; ++job) {
+                if (target.getWidth() != job->width || target.getHeight() != job->height) {
+                    if (!target.create(job->width, job->height)) {
+                        failedImages++;
+                        continue;
+                    }
+                }
+                target.bind();
+
+                renderThumbnail(*job, *model, *shaders[job->shader], lighting, renderQueue);
+
+                std::vector<unsigned char> pixels((size_t) job->width * job->height * 4);
+                glReadPixels(0, 0, job->width, job->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+                // Bounds the memory held by frames waiting for an encoder
+                if (pendingImages.size() >= maxPendingImages) {
+                    waitStart = std::chrono::steady_clock::now();
+                    failedImages += !pendingImages.front().get();
+                    pendingImages.pop_front();
+                    encodeWait += milliseconds(waitStart, std::chrono::steady_clock::now());
+                }
+
+                std::string path = (std::filesystem::path(options.batchOutput) / getThumbnailName(*job)).string();
+                int width = job->width;
+                int height = job->height;
+                pendingImages.push_back(pool.submit([path, pixels = std::move(pixels), width, height]() {
+                    return writePng(path, pixels.data(), width, height, true);
+                }));
+            }
+
+            // Released before the next model is uploaded to keep one model resident at a time
+            lighting.setModel(nullptr);
+            model.reset();
+        }
+
+        for (std::future<bool>& image : pendingImages) {
+            failedImages += !image.get();
+        }
+
+        target.reset();
+        lighting.cleanup();
+        TextureCache::getShared().clear();
+    }
+
+    double seconds = milliseconds(batchStart, std::chrono::steady_clock::now()) / 1000.0;
+    size_t writtenImages = jobs.size() - failedImages;
+
+    std::cout << "Batch: " << writtenImages << "/" << jobs.size() << " thumbnails of " << models.size() << " models written to "
+              << options.batchOutput << " in " << seconds << " s (" << writtenImages / seconds << " images/s)" << std::endl;
+    std::cout << "  waited " << loadWait << " ms for model loads, " << encodeWait << " ms for PNG encoders" << std::endl;
+
+    window.closeWindow();
+
+    return failedImages == 0 ? 0 : 1;
+}
@@ -1,4 +1,7 @@
+#include <cfloat>
+#include <cstdio>
 #include <iostream>
+#include <cstring>
 #include <GL/glew.h>
 #include <GL/gl.h>
 #include <memory>
@@ -8,6 +11,11 @@
 #include "imgui_impl_opengl3.h"
 #include <string>
 
+#ifdef HEADLESS_EGL
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
 #ifdef _WIN32
     #include <windows.h>
     #include <psapi.h>
@@ -18,10 +26,31 @@
 
 #include "window.hpp"
 #include "UIHandler.hpp"
+#include "rendering/gpuResource.hpp"
+#include "rendering/textureCache.hpp"
 #include "utils/constants.hpp"
 
-Window::Window() {
+Window::Window(bool headless, bool vsync) : headless(headless), vsync(vsync) {
     quit = false;
+    window = nullptr;
+    mainContext = nullptr;
+
+    if (headless) {
+        // SDL only provides the timer, there is no video device to open
+        if (SDL_Init(SDL_INIT_TIMER)) {
+            std::cerr << "Error initializing SDL:" << SDL_GetError() << std::endl;
+            std::exit(EXIT_FAILURE);
+        }
+
+        createHeadlessContext();
+        initializeOpenGL();
+
+        if (!offscreenTarget.create(HEADLESS_WIDTH, HEADLESS_HEIGHT)) {
+            std::exit(EXIT_FAILURE);
+        }
+        offscreenTarget.bind();
+        return;
+    }
 
     initializeSDL();
     initializeOpenGL();
@@ -67,9 +96,89 @@ void Window::createContext() {
     }
 }
 
+void Window::createHeadlessContext() {
+#ifdef HEADLESS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "Error initializing EGL! Error: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Without a surface, the context is made current with EGL_NO_SURFACE and draws into an FBO
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        std::cerr << "EGL " << major << "." << minor << " does not support surfaceless contexts" << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL does not support desktop OpenGL! Error: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    // Same version as the window context, software rasterizers may only reach 4.5, which the
+    // shaders are lowered to, see Shader::setSource
+    EGLContext context = EGL_NO_CONTEXT;
+    for (EGLint minorVersion : { 6, 5 }) {
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, minorVersion,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context != EGL_NO_CONTEXT) break;
+    }
+
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "Error creating headless OpenGL 4.5 context! Error: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        eglTerminate(display);
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "Error making the headless context current! Error: 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        std::exit(EXIT_FAILURE);
+    }
+
+    eglDisplay = display;
+    eglContext = context;
+#else
+    std::cerr << "Headless rendering is unavailable, this build was made without EGL" << std::endl;
+    std::exit(EXIT_FAILURE);
+#endif
+}
+
 void Window::initializeOpenGL() {
     // Enable V-Sync: Synchronize frame rate of application with the refresh rate of monitor
-    SDL_GL_SetSwapInterval(1);
+    if (!headless) {
+        SDL_GL_SetSwapInterval(vsync ? 1 : 0);
+    }
 
     // Check current version of OpenGL
     const GLubyte* version = glGetString(GL_VERSION);  
@@ -77,13 +186,26 @@ void Window::initializeOpenGL() {
         std::cout << "OpenGL Version: " << version << std::endl;
     } 
 
-    // Init GLEW: Provide access to modern OpenGL features
-    GLenum glewStatus = glewInit();
+    // Tells a software rasterizer apart from a GPU, notably on headless nodes
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    if (renderer) {
+        std::cout << "OpenGL Renderer: " << renderer << std::endl;
+    }
+
+    // Init GLEW: Provide access to modern OpenGL features. glewInit also loads the window
+    // system extensions, which fails without an X display in GLX builds of GLEW, so headless
+    // contexts only load the OpenGL entry points
+    GLenum glewStatus = headless ? glewContextInit() : glewInit();
     if (glewStatus != GLEW_OK) {
         std::cerr << "GLEW failed to initialize! Error: " << glewGetErrorString(glewStatus) << std::endl;
         std::exit(EXIT_FAILURE);
     }
 
+    // Let the driver compile shaders on its own threads when it can, see ShaderProgram::poll
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    }
+
     glClearColor(0, 0, 0, 1.0f);
 
     // Enables depth comparison, only rendering closes fragments
@@ -112,7 +234,7 @@ void Window::initializeImGui() {
     ImGui_ImplOpenGL3_Init(OPEN_GL_VERSION);
 }
 
-double Window::getMemoryUsage() const {
+double Window::getMemoryUsage() {
     #if defined(_WIN32)
        PROCESS_MEMORY_COUNTERS_EX pmc;
        GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc));
@@ -137,7 +259,7 @@ double Window::getMemoryUsage() const {
     #endif
    }
 
-void Window::drawPerformanceUI() {
+void Window::drawPerformanceUI(Model& obj, UIHandler& uiHandler) {
     float currentFPS = ImGui::GetIO().Framerate;
         
     // update FPS history
@@ -157,6 +279,38 @@ void Window::drawPerformanceUI() {
         ImVec2(0, 30)
     );
 
+    // GPU time of each pass, from timer queries read back once available
+    const GpuPassTimes& passTimes = uiHandler.getGpuPassTimes();
+    ImGui::Text("GPU Frame: %.3f ms", passTimes.getTotal());
+    for (int i = 0; i < (int) RenderPass::COUNT; i++) {
+        passHistory[i][passOffset] = passTimes.milliseconds[i];
+
+        char overlay[32];
+        std::snprintf(overlay, sizeof(overlay), "%.3f ms", passTimes.milliseconds[i]);
+        ImGui::PlotLines(RenderPassSelection::passes[i],
+            passHistory[i],
+            PASS_HISTORY_SIZE,
+            (passOffset + 1) % PASS_HISTORY_SIZE,
+            overlay,
+            0.0f,
+            FLT_MAX,
+            ImVec2(0, 30)
+        );
+    }
+    passOffset = (passOffset + 1) % PASS_HISTORY_SIZE;
+
+    // Triangles submitted at the selected levels of detail against the full resolution model
+    size_t drawnTriangles = obj.getDrawnTriangles();
+    size_t fullTriangles = obj.getTriangleCount() * obj.getInstanceCount();
+    ImGui::Text("Triangles: %zu / %zu per frame (%.0f%%)", drawnTriangles, fullTriangles, 
+                fullTriangles ? 100.0f * float(drawnTriangles) / float(fullTriangles) : 0.0f);
+    ImGui::Text("Meshes: %zu drawn, %zu culled", obj.getDrawnMeshes(), obj.getCulledMeshes());
+    ImGui::Text("Draw Calls: %zu for %zu instances", obj.getDrawCalls(), obj.getInstanceCount());
+
+    // What drawing every mesh directly would have cost against what the sorted render queue issued
+    const RenderQueueStats& renderStats = uiHandler.getRenderQueueStats();
+    ImGui::Text("State Changes: %zu -> %zu per frame (%zu packets)", renderStats.naiveStateChanges, renderStats.stateChanges, renderStats.packets);
+
     ImGui::Separator();
 
     float currentMemory = getMemoryUsage();
@@ -176,6 +330,26 @@ void Window::drawPerformanceUI() {
         AVG_MEMORY_USAGE + 20.0f,         
         ImVec2(0, 30)
     );
+
+    double memoryBefore = uiHandler.getMemoryBeforeLoad();
+    double memoryAfter = uiHandler.getMemoryAfterLoad();
+    ImGui::Text("Last Model Load: %.2f MB -> %.2f MB (%+.2f MB)", memoryBefore, memoryAfter, memoryAfter - memoryBefore);
+
+    // Live GPU allocations recorded by the resource handles
+    const GpuMemoryRegistry& gpuMemory = GpuMemoryRegistry::getShared();
+    ImGui::Text("GPU Memory: %.2f MB", gpuMemory.getTotalBytes() / (1024.0f * 1024.0f));
+    ImGui::Text("  Textures: %.2f MB (%zu)", gpuMemory.getBytes(GpuMemoryCategory::Textures) / (1024.0f * 1024.0f),
+                gpuMemory.getObjectCount(GpuMemoryCategory::Textures));
+    ImGui::Text("  Vertex Buffers: %.2f MB (%zu)", gpuMemory.getBytes(GpuMemoryCategory::VertexBuffers) / (1024.0f * 1024.0f),
+                gpuMemory.getObjectCount(GpuMemoryCategory::VertexBuffers));
+    ImGui::Text("  Index Buffers: %.2f MB (%zu)", gpuMemory.getBytes(GpuMemoryCategory::IndexBuffers) / (1024.0f * 1024.0f),
+                gpuMemory.getObjectCount(GpuMemoryCategory::IndexBuffers));
+    ImGui::Text("  Uniform Buffers: %.2f KB (%zu)", gpuMemory.getBytes(GpuMemoryCategory::UniformBuffers) / 1024.0f,
+                gpuMemory.getObjectCount(GpuMemoryCategory::UniformBuffers));
+    ImGui::Text("  Render Targets: %.2f MB (%zu)", gpuMemory.getBytes(GpuMemoryCategory::RenderTargets) / (1024.0f * 1024.0f),
+                gpuMemory.getObjectCount(GpuMemoryCategory::RenderTargets));
+    ImGui::Text("  Readback Buffers: %.2f MB (%zu)", gpuMemory.getBytes(GpuMemoryCategory::ReadbackBuffers) / (1024.0f * 1024.0f),
+                gpuMemory.getObjectCount(GpuMemoryCategory::ReadbackBuffers));
 }
 
 void Window::drawCameraUI(Camera& camera) {
@@ -226,12 +400,131 @@ void Window::drawModelUI(Model& obj, UIHandler& uiHandler) {
         uiHandler.setModelSelect(modelSelect);
     }
 
+    if (uiHandler.isLoadingModel()) {
+        ImGui::ProgressBar(uiHandler.getLoadProgress(), ImVec2(-1.0f, 0.0f), "Loading model...");
+    } else {
+        ImGui::Text("Load Time: %.1f ms (%s)", obj.getLoadTime(), obj.isLoadedFromCache() ? "warm, mesh cache" : "cold, Assimp import");
+    }
+
+    int importProfileSelect = uiHandler.getImportProfileSelect();
+    if (ImGui::Combo("Import Profile", &importProfileSelect, ImportProfileSelection::profiles, IM_ARRAYSIZE(ImportProfileSelection::profiles))) {
+        uiHandler.setImportProfileSelect(importProfileSelect);
+    }
+
+    bool meshOptimization = uiHandler.getMeshOptimization();
+    if (ImGui::Checkbox("Mesh Optimizer (vertex cache, overdraw, fetch)", &meshOptimization)) {
+        uiHandler.setMeshOptimization(meshOptimization);
+    }
+
+    bool packedVertices = uiHandler.getPackedVertices();
+    if (ImGui::Checkbox("Packed Vertices (16 bytes)", &packedVertices)) {
+        uiHandler.setPackedVertices(packedVertices);
+    }
+
+    bool splitIndexBuffers = uiHandler.getSplitIndexBuffers();
+    if (ImGui::Checkbox("Split Meshes for 16-bit Indices", &splitIndexBuffers)) {
+        uiHandler.setSplitIndexBuffers(splitIndexBuffers);
+    }
+
+    bool generateLods = uiHandler.getGenerateLods();
+    if (ImGui::Checkbox("Mesh LODs", &generateLods)) {
+        uiHandler.setGenerateLods(generateLods);
+    }
+
+    float lodPixelError = obj.getLodPixelError();
+    if (ImGui::SliderFloat("LOD Pixel Error", &lodPixelError, 0.0f, 8.0f, "%.1f px")) {
+        obj.setLodPixelError(lodPixelError);
+    }
+
+    bool frustumCulling = obj.isFrustumCulling();
+    if (ImGui::Checkbox("Frustum Culling", &frustumCulling)) {
+        obj.setFrustumCulling(frustumCulling);
+    }
+
+    int instanceCount = uiHandler.getInstanceCount();
+    if (ImGui::SliderInt("Instances", &instanceCount, 1, MAX_INSTANCE_COUNT, "%d", ImGuiSliderFlags_Logarithmic)) {
+        uiHandler.setInstanceCount(instanceCount);
+    }
+
+    bool instancedDrawing = obj.isInstancedDrawing();
+    if (ImGui::Checkbox("Instanced Drawing (one call per mesh)", &instancedDrawing)) {
+        obj.setInstancedDrawing(instancedDrawing);
+    }
+
+    bool leanResidency = uiHandler.getLeanResidency();
+    if (ImGui::Checkbox("Lean Residency (free CPU geometry, no picking)", &leanResidency)) {
+        uiHandler.setLeanResidency(leanResidency);
+    }
+
+    // Geometry before and after the profile's optimization passes
+    const ModelStats& sourceStats = obj.getSourceStats();
+    const ModelStats& stats = obj.getStats();
+    ImGui::Text("Meshes: %zu -> %zu", sourceStats.meshCount, stats.meshCount);
+    ImGui::Text("Vertices: %zu -> %zu", sourceStats.vertexCount, stats.vertexCount);
+    ImGui::Text("Indices: %zu -> %zu", sourceStats.indexCount, stats.indexCount);
+    ImGui::Text("Buffers: %.2f MB -> %.2f MB", sourceStats.getBufferBytes() / (1024.0f * 1024.0f), stats.getBufferBytes() / (1024.0f * 1024.0f));
+    ImGui::Text("ACMR: %.3f -> %.3f", sourceStats.getAcmr(), stats.getAcmr());
+    ImGui::Text("ATVR: %.3f -> %.3f", sourceStats.getAtvr(), stats.getAtvr());
+    ImGui::Text("Index Memory: %.2f MB -> %.2f MB (%zu of %zu meshes 16-bit)", sourceStats.getIndexBytes() / (1024.0f * 1024.0f), 
+                stats.getIndexBytes() / (1024.0f * 1024.0f), stats.shortIndexMeshes, stats.meshCount);
+    ImGui::Text("Index Fetch Saved: %.2f MB per frame", stats.getIndexBytesSaved() / (1024.0f * 1024.0f));
+    ImGui::Text("LODs: %zu levels, %.2f MB of indices", stats.lodCount, stats.lodIndexBytes / (1024.0f * 1024.0f));
+
+    // Decode error of the packed vertices against the float ones
+    if (obj.getSettings().packedVertices) {
+        const PackingError& packingError = obj.getPackingError();
+        ImGui::Text("Packing Error: %.2e position, %.3f° normal, %.2e UV", 
+                    packingError.maxPositionError, packingError.maxNormalError, packingError.maxTexCoordError);
+    }
+
+    const Bvh& bvh = obj.getBvh();
+    if (obj.isLeanResidency()) {
+        ImGui::Text("Picking BVH: not built with lean residency");
+    } else {
+        ImGui::Text("Picking BVH: %zu nodes, %.2f MB, built in %.1f ms", bvh.getNodeCount(), bvh.getMemoryBytes() / (1024.0f * 1024.0f), obj.getBvhBuildTime());
+    }
+
+    TextureCache& textureCache = TextureCache::getShared();
+    ImGui::Text("Textures: %zu resident, %zu hits, %zu uploads", textureCache.getResidentCount(), textureCache.getHits(), textureCache.getMisses());
+
+    int textureCacheCapacity = (int) textureCache.getCapacity();
+    if (ImGui::SliderInt("Texture Cache Size", &textureCacheCapacity, 0, 256)) {
+        textureCache.setCapacity(textureCacheCapacity);
+    }
+
+    ImGui::Separator(); 
+
+    if (obj.isLeanResidency()) {
+        ImGui::TextDisabled("Picking and measuring are unavailable with lean residency");
+    } else {
+        ImGui::TextDisabled("[Ctrl + Click] to pick and focus");
+        ImGui::TextDisabled("[Shift + Click] to measure");
+    }
+
+    const RayHit& pick = uiHandler.getLastPick();
+    if (pick.hit) {
+        ImGui::Text("Picked: instance %u, mesh %u, triangle %u at (%.3f, %.3f, %.3f)", pick.instanceIndex, pick.meshIndex, 
+                    pick.triangleIndex, pick.localPosition.x, pick.localPosition.y, pick.localPosition.z);
+    } else {
+        ImGui::Text("Picked: nothing");
+    }
+
+    if (uiHandler.getMeasurePointCount() == 2) {
+        ImGui::Text("Distance: %.4f model units", uiHandler.getMeasuredDistance());
+    } else {
+        ImGui::Text("Distance: %d of 2 points picked", uiHandler.getMeasurePointCount());
+    }
+
     ImGui::Separator(); 
 
     int shaderSelect = uiHandler.getShaderSelect();
     if (ImGui::Combo("Select Shader", &shaderSelect, ShaderSelection::shaders, IM_ARRAYSIZE(ShaderSelection::shaders))) {
         uiHandler.setShaderSelect(shaderSelect);
     }
+
+    if (uiHandler.isShaderCompiling()) {
+        ImGui::TextDisabled("Compiling shader...");
+    }
 }
 
 void Window::drawLightingUI(Lighting& lighting) {
@@ -281,6 +574,7 @@ void Window::drawLightingUI(Lighting& lighting) {
         if (ImGui::Checkbox("Draw Point Lights", &showPointLights)){
             lighting.setShowPointLights(showPointLights);
         }
+        ImGui::Text("Lighting Buffer Uploads: %zu", lighting.getUniformUploads());
         ImGui::Separator();
 
         std::vector<PointLight>& pointLights = *lighting.getPointLightsPointer();
@@ -325,7 +619,7 @@ void Window::drawUI(Camera& camera, Model& obj, Lighting& lighting, UIHandler& u
 
     ImGui::SetNextItemOpen(true, ImGuiCond_Once); 
     if (ImGui::CollapsingHeader("Performance")) {
-        drawPerformanceUI();
+        drawPerformanceUI(obj, uiHandler);
     }
 
     ImGui::SetNextItemOpen(true, ImGuiCond_Once); 
@@ -350,6 +644,8 @@ void Window::drawUI(Camera& camera, Model& obj, Lighting& lighting, UIHandler& u
 }
 
 void Window::renderImGui(Camera& camera, Model& obj, Lighting& lighting, UIHandler& uiHandler) {
+    if (headless) return;
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame();
     ImGui::NewFrame();
@@ -361,10 +657,30 @@ void Window::renderImGui(Camera& camera, Model& obj, Lighting& lighting, UIHandl
 }
 
 void Window::swapWindow() {
+    if (headless) {
+        glFlush();
+        return;
+    }
+
     SDL_GL_SwapWindow(window);
 }
 
 void Window::closeWindow() {
+    if (headless) {
+        offscreenTarget.reset();
+
+#ifdef HEADLESS_EGL
+        eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(eglDisplay, eglContext);
+        eglTerminate(eglDisplay);
+#endif
+        eglContext = nullptr;
+        eglDisplay = nullptr;
+
+        SDL_Quit();
+        return;
+    }
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
@@ -390,6 +706,14 @@ SDL_Window* Window::getWindow() const {
     return window;
 }
 
+bool Window::isHeadless() const {
+    return headless;
+}
+
+const RenderTarget& Window::getRenderTarget() const {
+    return offscreenTarget;
+}
+
 void Window::setWindowFullscreen() {
     SDL_GL_DeleteContext(mainContext);  // Destroy OpenGL context
     SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN_DESKTOP);